@@ -0,0 +1,70 @@
+#****************************************************************************
+#* gen_scenario.py
+#*
+#* Copyright 2023 Matthew Ballance and Contributors
+#*
+#* Licensed under the Apache License, Version 2.0 (the "License"); you may
+#* not use this file except in compliance with the License.
+#* You may obtain a copy of the License at:
+#*
+#*   http://www.apache.org/licenses/LICENSE-2.0
+#*
+#* Unless required by applicable law or agreed to in writing, software
+#* distributed under the License is distributed on an "AS IS" BASIS,
+#* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#* See the License for the specific language governing permissions and
+#* limitations under the License.
+#*
+#* Created on:
+#*     Author:
+#*
+#****************************************************************************
+import argparse
+
+def gen_scenario(fp, fanout, iterations):
+    """Emits a PSS model whose root action issues 'fanout' concurrent
+    target calls (one per parallel branch), 'iterations' times"""
+    fp.write("package bench_pkg {\n")
+    fp.write("    function void do_call(bit[32] id);\n")
+    fp.write("    import target function do_call;\n")
+    fp.write("}\n")
+    fp.write("\n")
+    fp.write("component pss_top {\n")
+    fp.write("    action leaf {\n")
+    fp.write("        rand bit[32] id;\n")
+    fp.write("        exec body {\n")
+    fp.write("            bench_pkg::do_call(id);\n")
+    fp.write("        }\n")
+    fp.write("    }\n")
+    fp.write("\n")
+    fp.write("    action root {\n")
+    fp.write("        activity {\n")
+    fp.write("            repeat (%d) {\n" % iterations)
+    if fanout > 1:
+        fp.write("                parallel {\n")
+        for i in range(fanout):
+            fp.write("                    do leaf;\n")
+        fp.write("                }\n")
+    else:
+        fp.write("                do leaf;\n")
+    fp.write("            }\n")
+    fp.write("        }\n")
+    fp.write("    }\n")
+    fp.write("}\n")
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-f", "--fanout", type=int, default=1,
+        help="Number of concurrent target calls per iteration")
+    parser.add_argument("-i", "--iterations", type=int, default=1,
+        help="Number of iterations of the fan-out")
+    parser.add_argument("-o", "--output", default="bench.pss",
+        help="Specifies output file")
+    args = parser.parse_args()
+
+    with open(args.output, "w") as fp:
+        gen_scenario(fp, args.fanout, args.iterations)
+
+if __name__ == "__main__":
+    main()
+
@@ -0,0 +1,102 @@
+#****************************************************************************
+#* run_bench.py
+#*
+#* Copyright 2023 Matthew Ballance and Contributors
+#*
+#* Licensed under the Apache License, Version 2.0 (the "License"); you may
+#* not use this file except in compliance with the License.
+#* You may obtain a copy of the License at:
+#*
+#*   http://www.apache.org/licenses/LICENSE-2.0
+#*
+#* Unless required by applicable law or agreed to in writing, software
+#* distributed under the License is distributed on an "AS IS" BASIS,
+#* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#* See the License for the specific language governing permissions and
+#* limitations under the License.
+#*
+#* Created on:
+#*     Author:
+#*
+#****************************************************************************
+import argparse
+import os
+import subprocess
+import sys
+from gen_scenario import gen_scenario
+
+# (actors, fanout) points. The actor sweep uses a single call per
+# iteration; the fan-out sweep uses a single actor.
+SCENARIOS = {
+    "actors" : [(1, 1), (10, 1), (100, 1), (1000, 1), (10000, 1)],
+    "fanout" : [(1, 1), (1, 10), (1, 100), (1, 1000)],
+    "mixed"  : [(10, 10), (100, 10), (100, 100)],
+    "quick"  : [(1, 1), (10, 10), (100, 1)]
+}
+
+def run_point(args, actors, fanout):
+    pss = os.path.join(args.workdir, "bench_f%d_i%d.pss" % (fanout, args.iterations))
+    if not os.path.isfile(pss):
+        with open(pss, "w") as fp:
+            gen_scenario(fp, fanout, args.iterations)
+
+    cmd = [args.driver, "-pss", pss, "-actors", str(actors)]
+    result = subprocess.run(cmd, stdout=subprocess.PIPE, universal_newlines=True)
+
+    if result.returncode != 0:
+        sys.stdout.write(result.stdout)
+        raise Exception("Benchmark point actors=%d fanout=%d failed" % (actors, fanout))
+
+    for line in result.stdout.splitlines():
+        if line.startswith("BENCH "):
+            fields = {}
+            for kv in line[len("BENCH "):].split():
+                k,v = kv.split("=")
+                fields[k] = float(v)
+            return fields
+    raise Exception("No result from actors=%d fanout=%d" % (actors, fanout))
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-d", "--driver", required=True,
+        help="Path to the zsp-sv-bench executable")
+    parser.add_argument("-s", "--scenarios", default="actors,fanout",
+        help="Comma-separated scenario sets (%s)" % ",".join(SCENARIOS.keys()))
+    parser.add_argument("-i", "--iterations", type=int, default=10,
+        help="Fan-out iterations per actor")
+    parser.add_argument("-w", "--workdir", default=".",
+        help="Directory for generated PSS files")
+    parser.add_argument("--max-growth", type=float, default=None,
+        help="Fail if a scenario set's per-completion cost grows by more "
+        "than this factor. By default, growth is only reported")
+    args = parser.parse_args()
+
+    os.makedirs(args.workdir, exist_ok=True)
+
+    status = 0
+    for s in args.scenarios.split(","):
+        print("Scenario set: %s" % s)
+        print("  %8s %8s %12s %12s %14s %14s" % (
+            "actors", "fanout", "completions", "ns/compl", "peak outst", "bytes/outst"))
+        costs = []
+        for actors,fanout in SCENARIOS[s]:
+            r = run_point(args, actors, fanout)
+            costs.append(r["eval_ns_per_completion"])
+            print("  %8d %8d %12d %12.1f %14d %14.1f" % (
+                actors, fanout,
+                r["completions"],
+                r["eval_ns_per_completion"],
+                r["peak_outstanding"],
+                r["bytes_per_outstanding"]), flush=True)
+        if len(costs) > 1 and min(costs) > 0:
+            growth = max(costs) / min(costs)
+            print("  per-completion cost growth: %.2fx" % growth)
+            if args.max_growth is not None and growth > args.max_growth:
+                print("  ERROR: per-completion cost is not flat across set %s" % s)
+                status = 1
+
+    return status
+
+if __name__ == "__main__":
+    sys.exit(main())
+
@@ -0,0 +1,262 @@
+/*
+ * zsp_sv_bench.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ *
+ * Headless benchmark driver. Runs a set of actors, created through the
+ * native C++ API, whose backends complete every outstanding target call 
+ * at the end of each simulated timestep. Calls take the production
+ * dispatch and completion path (call arenas, NativeBackend handlers, 
+ * Actor result handling). Reports evaluation cost per completion and 
+ * memory per outstanding call.
+ *
+ * Apart from the heap profiler, only the public API is used, so the 
+ * driver can also be linked against zsp-sv-bundle, whose internals are
+ * hidden (ZUSPEC_SV_BENCH_BUNDLE). Memory is then measured with mallinfo.
+ */
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "zsp/sv/FactoryExt.h"
+#ifndef ZUSPEC_SV_BENCH_BUNDLE
+#include "HeapProf.h"
+#endif
+
+using namespace zsp;
+
+/**
+ * Holds an actor's target calls until the end of the timestep. Solve
+ * calls are completed as they are issued
+ */
+class BenchCalls {
+public:
+    BenchCalls() : m_completions(0) { }
+
+    void bind(sv::IBackend *backend) {
+        backend->setDefaultFuncHandler([this](sv::IFuncCall *call) {
+            if (call->isTarget()) {
+                m_pending.push_back(call);
+            } else {
+                complete(call);
+            }
+        });
+    }
+
+    /**
+     * Completes all outstanding calls. Returns the number completed
+     */
+    uint32_t completeAll() {
+        uint32_t n = m_pending.size();
+        // Completion may issue new calls, so work from a copy
+        std::vector<sv::IFuncCall *> pending;
+        pending.swap(m_pending);
+        for (std::vector<sv::IFuncCall *>::const_iterator
+            it=pending.begin();
+            it!=pending.end(); it++) {
+            complete(*it);
+        }
+        return n;
+    }
+
+    uint32_t numPending() const {
+        return m_pending.size();
+    }
+
+    uint64_t numCompletions() const {
+        return m_completions;
+    }
+
+private:
+    void complete(sv::IFuncCall *call) {
+        // The call object is released once completed
+        if (call->hasResult()) {
+            call->setIntResult(0);
+        } else {
+            call->setVoidResult();
+        }
+        m_completions++;
+    }
+
+private:
+    std::vector<sv::IFuncCall *>        m_pending;
+    uint64_t                            m_completions;
+};
+
+static uint64_t heap_in_use() {
+#ifndef ZUSPEC_SV_BENCH_BUNDLE
+    if (sv::HeapProf::enabled()) {
+        return sv::HeapProf::total()->liveBytes();
+    }
+#endif
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 mi = mallinfo2();
+#else
+    struct mallinfo mi = mallinfo();
+#endif
+    return mi.uordblks + mi.hblkhd;
+}
+
+static void usage() {
+    fprintf(stdout,
+        "Usage: zsp-sv-bench -pss <file> [-comp <type>] [-action <type>]\n"
+        "                    [-actors <n>] [-seed <seed>]\n");
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    std::string pss_files;
+    std::string comp_t_s = "pss_top";
+    std::string action_t_s = "pss_top::root";
+    std::string seed = "0";
+    int32_t n_actors = 1;
+    char tmp[1024];
+
+    for (int32_t i=1; i<argc; i++) {
+        if (!strcmp(argv[i], "-pss") && i+1 < argc) {
+            pss_files = argv[++i];
+        } else if (!strcmp(argv[i], "-comp") && i+1 < argc) {
+            comp_t_s = argv[++i];
+        } else if (!strcmp(argv[i], "-action") && i+1 < argc) {
+            action_t_s = argv[++i];
+        } else if (!strcmp(argv[i], "-actors") && i+1 < argc) {
+            n_actors = strtol(argv[++i], 0, 0);
+        } else if (!strcmp(argv[i], "-seed") && i+1 < argc) {
+            seed = argv[++i];
+        } else {
+            usage();
+        }
+    }
+
+    if (pss_files == "" || n_actors < 1) {
+        usage();
+    }
+
+    sv::IFactory *factory = zsp_sv_getFactory();
+    factory->setMessageHandler(
+        [](sv::MessageLevel level, const std::string &msg) {
+            fprintf(stdout, "ZuspecSv%s: %s\n", 
+                (level == sv::MessageLevel::Info)?"":
+                (level == sv::MessageLevel::Error)?" ERROR":" FATAL",
+                msg.c_str());
+            if (level == sv::MessageLevel::Fatal) {
+                exit(1);
+            }
+        });
+
+    // Loading is otherwise deferred to the first actor. Load up front, 
+    // so that per-actor memory and elaboration time exclude it
+    if (!factory->init(pss_files) || !factory->load()) {
+        factory->emitMessage(sv::MessageLevel::Fatal, "Failed to initialize");
+    }
+
+    uint64_t heap_base = heap_in_use();
+
+    std::chrono::steady_clock::time_point t_elab = std::chrono::steady_clock::now();
+    std::vector<BenchCalls> calls(n_actors);
+    std::vector<sv::IActor *> actors;
+    for (int32_t i=0; i<n_actors; i++) {
+        char seed_i[64];
+        snprintf(seed_i, sizeof(seed_i), "%s.%d", seed.c_str(), i);
+        sv::IBackend *backend = factory->mkBackend();
+        calls[i].bind(backend);
+        sv::IActor *actor = factory->mkActor(seed_i, comp_t_s, action_t_s, backend);
+        if (!actor) {
+            snprintf(tmp, sizeof(tmp), "Failed to create actor %d: %s", 
+                i, factory->getLastError().c_str());
+            factory->emitMessage(sv::MessageLevel::Fatal, tmp);
+        }
+        actors.push_back(actor);
+    }
+    uint64_t elab_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - t_elab).count();
+
+    uint64_t heap_elab = heap_in_use();
+
+    // Each loop iteration models one simulation timestep: evaluate every
+    // runnable actor, then complete every call issued during the step.
+    std::vector<bool> running(n_actors, true);
+    int32_t n_running = n_actors;
+    uint64_t eval_ns = 0;
+    uint64_t n_evals = 0;
+    uint64_t n_steps = 0;
+    uint64_t peak_outstanding = 0;
+    uint64_t peak_outstanding_heap = 0;
+
+    while (n_running) {
+        std::chrono::steady_clock::time_point t_eval = std::chrono::steady_clock::now();
+        for (int32_t i=0; i<n_actors; i++) {
+            if (running[i]) {
+                n_evals++;
+                if (!actors[i]->eval()) {
+                    running[i] = false;
+                    n_running--;
+                } else if (!calls[i].numPending()) {
+                    snprintf(tmp, sizeof(tmp), "Actor %d: evaluation stalled", i);
+                    factory->emitMessage(sv::MessageLevel::Fatal, tmp);
+                }
+            }
+        }
+        eval_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t_eval).count();
+
+        uint64_t outstanding = 0;
+        for (int32_t i=0; i<n_actors; i++) {
+            outstanding += calls[i].numPending();
+        }
+
+        if (outstanding > peak_outstanding) {
+            peak_outstanding = outstanding;
+            peak_outstanding_heap = heap_in_use();
+        }
+
+        for (int32_t i=0; i<n_actors; i++) {
+            calls[i].completeAll();
+        }
+        n_steps++;
+    }
+
+    uint64_t completions = 0;
+    for (int32_t i=0; i<n_actors; i++) {
+        completions += calls[i].numCompletions();
+    }
+
+    int64_t outstanding_bytes = (int64_t)peak_outstanding_heap - (int64_t)heap_elab;
+
+    fprintf(stdout,
+        "BENCH actors=%d steps=%llu evals=%llu completions=%llu "
+        "elab_us=%llu eval_us=%llu eval_ns_per_completion=%.1f "
+        "actor_bytes=%llu peak_outstanding=%llu bytes_per_outstanding=%.1f\n",
+        n_actors,
+        (unsigned long long)n_steps,
+        (unsigned long long)n_evals,
+        (unsigned long long)completions,
+        (unsigned long long)(elab_ns / 1000),
+        (unsigned long long)(eval_ns / 1000),
+        (completions)?((double)eval_ns / completions):0.0,
+        (unsigned long long)((heap_elab - heap_base) / n_actors),
+        (unsigned long long)peak_outstanding,
+        (peak_outstanding && outstanding_bytes > 0)?
+            ((double)outstanding_bytes / peak_outstanding):0.0);
+
+    return 0;
+}
+
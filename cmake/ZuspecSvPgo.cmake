@@ -0,0 +1,133 @@
+#****************************************************************************
+#* ZuspecSvPgo.cmake
+#*
+#* Profile-guided optimization support for zsp-sv.
+#*
+#* ZUSPEC_SV_PGO selects the mode:
+#*   OFF      - no PGO
+#*   GENERATE - build instrumented libraries that write profiles to
+#*              ZUSPEC_SV_PGO_DIR
+#*   USE      - build optimized libraries using the profiles in
+#*              ZUSPEC_SV_PGO_DIR
+#*   ON       - full pipeline: configure and build an instrumented copy of
+#*              this project, run the headless benchmark scenarios to
+#*              collect profiles, then build this tree in USE mode
+#****************************************************************************
+
+set(ZUSPEC_SV_PGO "OFF" CACHE STRING
+  "Profile-guided optimization mode (OFF, GENERATE, USE, ON)")
+set_property(CACHE ZUSPEC_SV_PGO PROPERTY STRINGS OFF GENERATE USE ON)
+set(ZUSPEC_SV_PGO_DIR ${CMAKE_BINARY_DIR}/pgo-data CACHE PATH
+  "Directory holding PGO profile data")
+set(ZUSPEC_SV_PGO_SCENARIOS "quick,mixed" CACHE STRING
+  "Benchmark scenario sets used to train the PGO build")
+
+set(pgo_mode ${ZUSPEC_SV_PGO})
+if (pgo_mode STREQUAL "ON")
+  set(pgo_mode "USE")
+  set(pgo_pipeline 1)
+endif()
+
+if (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+  set(pgo_profdata ${ZUSPEC_SV_PGO_DIR}/zsp-sv.profdata)
+  set(pgo_gen_flags -fprofile-generate=${ZUSPEC_SV_PGO_DIR})
+  set(pgo_use_flags
+    -fprofile-use=${pgo_profdata}
+    -Wno-profile-instr-unprofiled
+    -Wno-profile-instr-out-of-date)
+  get_filename_component(pgo_cxx_dir ${CMAKE_CXX_COMPILER} DIRECTORY)
+  find_program(LLVM_PROFDATA
+    NAMES llvm-profdata
+    HINTS ${pgo_cxx_dir})
+elseif (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+  # Profiles are keyed by object path. Strip the build directory so the
+  # instrumented sub-build and this build share profile names. Each 
+  # target's objects are trained under their own names, so targets built
+  # from the same sources with different flags (eg zsp-sv-bundle's hidden
+  # visibility) get matching profiles
+  set(pgo_gcc 1)
+  set(pgo_gen_flags
+    -fprofile-generate
+    -fprofile-update=atomic
+    -fprofile-dir=${ZUSPEC_SV_PGO_DIR})
+  set(pgo_use_flags
+    -fprofile-use
+    -fprofile-dir=${ZUSPEC_SV_PGO_DIR}
+    -fprofile-partial-training
+    -Wno-missing-profile)
+  if (CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 12.0)
+    list(APPEND pgo_gen_flags -fprofile-prefix-path=${CMAKE_BINARY_DIR})
+    list(APPEND pgo_use_flags -fprofile-prefix-path=${CMAKE_BINARY_DIR})
+  elseif(pgo_pipeline)
+    message(WARNING
+      "ZUSPEC_SV_PGO=ON requires GCC 12 or newer to match profiles across build directories")
+  endif()
+elseif (NOT pgo_mode STREQUAL "OFF")
+  message(FATAL_ERROR "ZUSPEC_SV_PGO is not supported with ${CMAKE_CXX_COMPILER_ID}")
+endif()
+
+if (pgo_mode STREQUAL "GENERATE")
+  string(REPLACE ";" " " pgo_gen_flags_s "${pgo_gen_flags}")
+  add_compile_options(${pgo_gen_flags})
+  set(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} ${pgo_gen_flags_s}")
+  set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${pgo_gen_flags_s}")
+elseif (pgo_mode STREQUAL "USE")
+  add_compile_options(${pgo_use_flags})
+endif()
+
+if (pgo_pipeline)
+  include(ExternalProject)
+
+  if (CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+    if (NOT LLVM_PROFDATA)
+      message(FATAL_ERROR "ZUSPEC_SV_PGO=ON requires llvm-profdata")
+    endif()
+    set(pgo_merge_cmd
+      COMMAND ${CMAKE_COMMAND}
+        -DLLVM_PROFDATA=${LLVM_PROFDATA}
+        -DPGO_DIR=${ZUSPEC_SV_PGO_DIR}
+        -DPGO_PROFDATA=${pgo_profdata}
+        -P ${CMAKE_CURRENT_LIST_DIR}/ZuspecSvPgoMerge.cmake)
+  endif()
+
+  # Instrumented copy of this project. Building it runs the benchmark
+  # scenarios, which leave profiles in ZUSPEC_SV_PGO_DIR. When the bundle
+  # is enabled, the scenarios are also run against it to train its 
+  # objects. Profiles are collected once; build the zsp-sv-pgo-gen-build
+  # target to retrain.
+  set(pgo_bundle_args -DZUSPEC_SV_BUNDLE=${ZUSPEC_SV_BUNDLE})
+  foreach(var ZUSPEC_SV_BUNDLE_LIBS ZUSPEC_SV_BUNDLE_LIBDIRS)
+    if (DEFINED ${var})
+      string(REPLACE ";" "|" val "${${var}}")
+      list(APPEND pgo_bundle_args -D${var}=${val})
+    endif()
+  endforeach()
+
+  ExternalProject_Add(zsp-sv-pgo-gen
+    SOURCE_DIR ${CMAKE_SOURCE_DIR}
+    BINARY_DIR ${CMAKE_BINARY_DIR}/pgo-gen
+    CMAKE_ARGS
+      -DCMAKE_BUILD_TYPE=${CMAKE_BUILD_TYPE}
+      -DCMAKE_CXX_COMPILER=${CMAKE_CXX_COMPILER}
+      -DPACKAGES_DIR=${PACKAGES_DIR}
+      -DZUSPEC_SV_PGO=GENERATE
+      -DZUSPEC_SV_PGO_DIR=${ZUSPEC_SV_PGO_DIR}
+      -DZUSPEC_SV_BENCH=ON
+      -DZUSPEC_SV_BENCH_SCENARIOS=${ZUSPEC_SV_PGO_SCENARIOS}
+      ${pgo_bundle_args}
+    LIST_SEPARATOR |
+    BUILD_COMMAND
+      ${CMAKE_COMMAND} -E remove_directory ${ZUSPEC_SV_PGO_DIR}
+      COMMAND ${CMAKE_COMMAND} --build <BINARY_DIR> --target bench
+      ${pgo_merge_cmd}
+    STEP_TARGETS build
+    INSTALL_COMMAND "")
+endif()
+
+# Makes an optimized target depend on profile collection when running the
+# full pipeline
+function(zuspec_sv_pgo_target target)
+  if (pgo_pipeline)
+    add_dependencies(${target} zsp-sv-pgo-gen)
+  endif()
+endfunction()
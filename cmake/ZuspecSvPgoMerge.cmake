@@ -0,0 +1,21 @@
+#****************************************************************************
+#* ZuspecSvPgoMerge.cmake
+#*
+#* Merges raw LLVM profiles produced by the instrumented benchmark run.
+#* Invoked with -DLLVM_PROFDATA=... -DPGO_DIR=... -DPGO_PROFDATA=...
+#****************************************************************************
+
+file(GLOB profraw "${PGO_DIR}/*.profraw")
+
+if (NOT profraw)
+  message(FATAL_ERROR "No profiles found in ${PGO_DIR}")
+endif()
+
+execute_process(
+  COMMAND ${LLVM_PROFDATA} merge -o ${PGO_PROFDATA} ${profraw}
+  RESULT_VARIABLE res)
+
+if (NOT res EQUAL 0)
+  message(FATAL_ERROR "llvm-profdata merge failed")
+endif()
+
@@ -0,0 +1,124 @@
+/*
+ * PyEvalBackend.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include "PyEvalBackend.h"
+#include "ZuspecSvDpiImp.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+PyEvalBackend::PyEvalBackend(PyObject *obj) : m_obj(obj), m_actor(0) {
+
+}
+
+PyEvalBackend::~PyEvalBackend() {
+
+}
+
+void PyEvalBackend::callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) {
+    m_actor->callIssued(thread, func_t);
+
+    m_callFuncReq(
+        m_obj,
+        thread,
+        func_t,
+        !func_t->hasFlags(arl::dm::DataTypeFunctionFlags::Solve),
+        &params);
+}
+
+void PyEvalBackend::enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_actor->actionStart(thread, action_t, action_v);
+}
+
+void PyEvalBackend::leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_actor->actionComplete(thread, action_t, action_v);
+}
+
+void PyEvalBackend::emitMessage(const std::string &msg) {
+    m_emitMessage(m_obj, msg.c_str());
+}
+
+void PyEvalBackend::setCallbacks(
+        PyCallFuncReqF                  callFuncReq,
+        PyEmitMessageF                  emitMessage) {
+    m_callFuncReq = callFuncReq;
+    m_emitMessage = emitMessage;
+}
+
+PyCallFuncReqF PyEvalBackend::m_callFuncReq = 0;
+PyEmitMessageF PyEvalBackend::m_emitMessage = 0;
+
+static thread_local std::string prv_error;
+
+std::string PyDpiHost_takeError() {
+    std::string ret;
+    ret.swap(prv_error);
+    return ret;
+}
+
+}
+}
+
+/****************************************************************************
+ * Host implementations of the SV-side DPI exports. Fatal errors are saved
+ * so the Python wrapper can raise them once control returns. Other errors
+ * (eg call-timeout reports) are only displayed
+ ****************************************************************************/
+extern "C" void zuspec_message(const char *msg) {
+    fprintf(stdout, "ZuspecSv: %s\n", msg);
+    fflush(stdout);
+}
+
+extern "C" void zuspec_error(const char *msg) {
+    fprintf(stdout, "ZuspecSv ERROR: %s\n", msg);
+    fflush(stdout);
+}
+
+extern "C" void zuspec_fatal(const char *msg) {
+    zsp::sv::prv_error = msg;
+}
+
+extern "C" void zuspec_EvalBackendProxy_emitMessage(
+    chandle     proxy_h,
+    const char *msg) {
+    zuspec_fatal("EvalBackendProxy is not supported from Python");
+}
+
+extern "C" void zuspec_EvalBackendProxy_callFuncReq(
+    chandle             proxy_h,
+    chandle             thread_h,
+    chandle             func_t,
+    uint32_t            is_target,
+    const chandle       params_h) {
+    zuspec_fatal("EvalBackendProxy is not supported from Python");
+}
+
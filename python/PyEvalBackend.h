@@ -0,0 +1,95 @@
+/**
+ * PyEvalBackend.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <Python.h>
+#include <string>
+#include "zsp/arl/eval/impl/EvalBackendBase.h"
+#include "Actor.h"
+
+namespace zsp {
+namespace sv {
+
+typedef void (*PyCallFuncReqF)(
+    PyObject                            *obj,
+    arl::eval::IEvalThread              *thread,
+    arl::dm::IDataTypeFunction          *func_t,
+    bool                                is_target,
+    const std::vector<vsc::dm::ValRef>  *params);
+
+typedef void (*PyEmitMessageF)(
+    PyObject                            *obj,
+    const char                          *msg);
+
+/**
+ * Evaluation backend that forwards requests to a Python object. The
+ * callbacks are installed by zsp_sv.core at module load. Like
+ * EvalBackendProxy, calls and actions are reported to the bound actor
+ */
+class PyEvalBackend : public virtual arl::eval::EvalBackendBase {
+public:
+    PyEvalBackend(PyObject *obj);
+
+    virtual ~PyEvalBackend();
+
+    virtual void callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) override;
+
+    virtual void enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void emitMessage(const std::string &msg) override;
+
+    void setActor(Actor *actor) {
+        m_actor = actor;
+    }
+
+    static void setCallbacks(
+        PyCallFuncReqF                  callFuncReq,
+        PyEmitMessageF                  emitMessage);
+
+private:
+    static PyCallFuncReqF               m_callFuncReq;
+    static PyEmitMessageF               m_emitMessage;
+    // Borrowed: the Python backend object owns this proxy
+    PyObject                            *m_obj;
+    Actor                               *m_actor;
+
+};
+
+/**
+ * Returns and clears the last fatal message reported by zsp-sv
+ * via the DPI message hooks on this thread
+ */
+std::string PyDpiHost_takeError();
+
+}
+}
+
+
@@ -0,0 +1,255 @@
+# cython: language_level=3
+#****************************************************************************
+#* core.pyx
+#*
+#* Python bindings for the zuspec-sv actor runtime. Allows a Python host
+#* (eg cocotb or a pure-Python testbench) to drive PSS actors in-process,
+#* with target calls dispatched to Python methods.
+#*
+#* Copyright 2023 Matthew Ballance and Contributors
+#*
+#* Licensed under the Apache License, Version 2.0 (the "License"); you may
+#* not use this file except in compliance with the License.
+#* You may obtain a copy of the License at:
+#*
+#*   http://www.apache.org/licenses/LICENSE-2.0
+#*
+#* Unless required by applicable law or agreed to in writing, software
+#* distributed under the License is distributed on an "AS IS" BASIS,
+#* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#* See the License for the specific language governing permissions and
+#* limitations under the License.
+#*
+#****************************************************************************
+cimport zsp_sv.decl as decl
+cimport cpython.ref as cpy_ref
+from libc.stdint cimport int32_t, int64_t, uint32_t, uint64_t
+from libcpp cimport bool
+from libcpp.vector cimport vector as cpp_vector
+
+cdef extern from *:
+    void zuspec_fatal(const char *msg)
+
+cdef decl_fatal(str msg):
+    zuspec_fatal(msg.encode())
+
+# Backends bound to actors. Actors live for the life of the process and
+# call into their backend, so the backend must as well
+_bound_backends = []
+
+cdef _check_error(msg):
+    err = decl.PyDpiHost_takeError().decode()
+    if err != "":
+        raise RuntimeError(err)
+    elif msg is not None:
+        raise RuntimeError(msg)
+
+cdef class ZuspecSv(object):
+
+    @staticmethod
+    def inst():
+        return ZuspecSv.mk(decl.ZuspecSv_inst())
+
+    def init(self, pss_files, load=True, debug=False):
+        """Specifies the PSS file to load"""
+        if not self._hndl.init(pss_files.encode(), load, debug):
+            _check_error("Failed to initialize")
+
+    def ensureLoaded(self):
+        if not self._hndl.ensureLoaded():
+            _check_error("Failed to load PSS files")
+
+    def mkModel(self, name, pss_files, load_async=True):
+        """Creates a named model. By default, loading starts immediately
+        on a background thread"""
+        cdef decl.Model *hndl = self._hndl.mkModel(name.encode(), pss_files.encode())
+        if hndl == NULL:
+            _check_error("Failed to create model %s" % name)
+        if load_async:
+            hndl.loadAsync()
+        return name
+
+    def mkActor(self, comp_t, action_t, EvalBackend backend, seed="0", model=None):
+        cdef decl.Model *model_h = NULL
+        if backend._actor is not None:
+            raise RuntimeError("Backend is already bound to an actor")
+        if model is not None:
+            model_h = self._hndl.findModel(model.encode())
+            if model_h == NULL:
+                raise RuntimeError("No model named %s" % model)
+        cdef decl.Actor *hndl = self._hndl.mkActor(
+            model_h,
+            str(seed).encode(),
+            comp_t.encode(),
+            action_t.encode(),
+            backend._hndl)
+        if hndl == NULL:
+            _check_error("Failed to create actor")
+        backend._hndl.setActor(hndl)
+        ret = Actor()
+        ret._hndl = hndl
+        ret._backend = backend
+        ret._resumed = False
+        ret._wake = None
+        backend._actor = ret
+        _bound_backends.append(backend)
+        return ret
+
+    def enableStats(self, name=""):
+        return self._hndl.enableStats(name.encode())
+
+    def report(self):
+        self._hndl.report()
+
+    @staticmethod
+    cdef ZuspecSv mk(decl.ZuspecSv *hndl):
+        ret = ZuspecSv()
+        ret._hndl = hndl
+        return ret
+
+cdef class EvalBackend(object):
+    """Base class for Python backends. Subclasses override callFuncReq to
+    handle solve and target function calls. A call is complete once
+    thread.setVoidResult() or thread.setIntResult() has been called. This
+    may happen inside callFuncReq or later, before the next Actor.eval()"""
+    def __cinit__(self):
+        self._hndl = new decl.PyEvalBackend(<cpy_ref.PyObject *>self)
+
+    def __dealloc__(self):
+        del self._hndl
+
+    def callFuncReq(self, EvalThread thread, str name, bool is_target, params):
+        raise NotImplementedError("callFuncReq: %s" % name)
+
+    def emitMessage(self, msg):
+        print("ZuspecSv: %s" % msg)
+
+cdef class EvalThread(object):
+
+    def setVoidResult(self):
+        self._actor._hndl.setVoidResult(self._hndl)
+        self._actor._resume()
+
+    def setIntResult(self, int64_t value, bool is_signed=False, int32_t width=64):
+        self._actor._hndl.setIntResult(self._hndl, value, is_signed, width)
+        self._actor._resume()
+
+    def getAddrHandleValue(self, ValRef ref):
+        return self._hndl.getAddrHandleValue(ref._val).get_val_u()
+
+    @staticmethod
+    cdef EvalThread mk(Actor actor, decl.IEvalThread *hndl):
+        ret = EvalThread()
+        ret._actor = actor
+        ret._hndl = hndl
+        return ret
+
+cdef class ValRef(object):
+
+    def get_uint(self):
+        return decl.ValRefInt(self._val).get_val_u()
+
+    def get_int(self):
+        return decl.ValRefInt(self._val).get_val_s()
+
+    def __int__(self):
+        if decl.ValRefInt(self._val).is_signed():
+            return self.get_int()
+        else:
+            return self.get_uint()
+
+    @staticmethod
+    cdef ValRef mk(const decl.ValRef &val):
+        ret = ValRef()
+        ret._val = val
+        return ret
+
+cdef class Actor(object):
+
+    def eval(self):
+        """Runs the actor until it blocks. Returns True while the actor
+        has work outstanding"""
+        cdef int32_t ret
+        with nogil:
+            ret = self._hndl.eval()
+        _check_error(None)
+        return ret != 0
+
+    def evalBudget(self, uint64_t max_us):
+        """Like eval(), but returns 2 once about max_us microseconds of
+        evaluation work are done. Call again to resume. Applies to streamed
+        actors, which yield between iterations; other actors run without
+        the budget and warn once"""
+        cdef int32_t ret
+        with nogil:
+            ret = self._hndl.evalBudget(max_us)
+        _check_error(None)
+        return ret
+
+    def registerFunctionId(self, name, int32_t id):
+        return self._hndl.registerFunctionId(name.encode(), id)
+
+    @property
+    def id(self):
+        return self._hndl.id()
+
+    @property
+    def backend(self):
+        return self._backend
+
+    async def run(self):
+        """Evaluates the actor to completion. Calls left outstanding by the
+        backend must be completed, from the event-loop thread, by 
+        awaitables the backend schedules. The actor waits for a result 
+        before evaluating again"""
+        import asyncio
+        loop = asyncio.get_running_loop()
+        self._resumed = False
+        while self.eval():
+            if not self._resumed:
+                self._wake = loop.create_future()
+                try:
+                    await self._wake
+                finally:
+                    self._wake = None
+            self._resumed = False
+
+    def _resume(self):
+        self._resumed = True
+        if self._wake is not None and not self._wake.done():
+            self._wake.set_result(None)
+
+cdef void _callFuncReq(
+        cpy_ref.PyObject                *obj,
+        decl.IEvalThread                *thread,
+        decl.IDataTypeFunction          *func_t,
+        bool                            is_target,
+        const cpp_vector[decl.ValRef]   *params) noexcept with gil:
+    cdef EvalBackend backend = <EvalBackend>obj
+    cdef uint32_t i
+    try:
+        py_params = []
+        for i in range(params.size()):
+            py_params.append(ValRef.mk(params.at(i)))
+        backend.callFuncReq(
+            EvalThread.mk(backend._actor, thread),
+            func_t.name().decode(),
+            is_target,
+            py_params)
+    except Exception as e:
+        # Surface to the next eval() as a RuntimeError
+        import traceback
+        traceback.print_exc()
+        decl_fatal(str(e))
+
+cdef void _emitMessage(
+        cpy_ref.PyObject                *obj,
+        const char                      *msg) noexcept with gil:
+    try:
+        (<EvalBackend>obj).emitMessage(msg.decode())
+    except Exception:
+        import traceback
+        traceback.print_exc()
+
+decl.PyEvalBackend_setCallbacks(_callFuncReq, _emitMessage)
+
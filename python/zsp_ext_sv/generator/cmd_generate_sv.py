@@ -127,12 +127,13 @@ class CmdGenerateSv(arl_dm.VisitorBase,CmdParseBase):
         self.out.inc_ind()
         self.out.println("string     comp_t,")
         self.out.println("string     action_t,")
-        self.out.println("TARGET_T   targets[]")
+        self.out.println("TARGET_T   targets[],")
+        self.out.println("Model      model=null")
         self.out.dec_ind()
         self.out.println(");")
         self.out.inc_ind()
         self.out.println("m_targets = new[targets.size()](targets);")
-        self.out.println("m_core    = new(comp_t, action_t, this);")
+        self.out.println("m_core    = new(comp_t, action_t, this, \"\", model);")
         self.out.dec_ind()
         self.out.println("endfunction")
         self.out.println("")
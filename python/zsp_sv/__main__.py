@@ -20,6 +20,9 @@
 #*
 #****************************************************************************
 import argparse
+import os
+import sys
+import time
 import debug_mgr
 import vsc_dm
 import vsc_solvers
@@ -38,6 +41,31 @@ def cmd_ldpath(args):
     print(":".join(paths))
 
 def cmd_ldflags(args):
+    if args.bundle:
+        # The bundle is self-contained, so only zsp-sv's own libdir is needed.
+        # It is only built with -DZUSPEC_SV_BUNDLE=ON, and is not part of
+        # the default package data
+        import zsp_sv
+        dirs = []
+        for d in zsp_sv.get_libdirs():
+            for ext in (".so", ".dylib", ".dll"):
+                if os.path.isfile(os.path.join(d, "libzsp-sv-bundle%s" % ext)):
+                    dirs.append(d)
+                    break
+        if len(dirs) == 0:
+            sys.stderr.write(
+                "Error: libzsp-sv-bundle not found in %s. Build with "
+                "-DZUSPEC_SV_BUNDLE=ON and copy the library there\n" % (
+                    ", ".join(zsp_sv.get_libdirs())))
+            sys.exit(1)
+        flags = []
+        for d in dirs:
+            flags.append("-L%s" % d)
+            flags.append("-Wl,-rpath=%s" % d)
+        flags.append("-lzsp-sv-bundle")
+        print(" ".join(flags))
+        return
+
     pkgs = [
         zsp_arl_eval,
         zsp_fe_parser, 
@@ -66,6 +94,86 @@ def cmd_ldflags(args):
     
     print(" ".join(flags))
 
+def cmd_stats(args):
+    from .stats import StatsReader, list_segments
+
+    name = args.name
+    if name is None:
+        segments = list_segments()
+        if len(segments) == 0:
+            print("No zsp-sv statistics segments found")
+            sys.exit(1)
+        elif len(segments) > 1:
+            print("Multiple segments found; specify one of: %s" % " ".join(segments))
+            sys.exit(1)
+        name = segments[0]
+
+    reader = StatsReader(name)
+    print("Attached to %s (pid %d)" % (name, reader.pid))
+    print("%8s %7s %10s %10s %10s %9s %10s %7s" % (
+        "time(s)", "actors", "evals/s", "actions/s", "calls/s", "in-flight", "solves/s", "solve%"))
+
+    start = time.monotonic()
+    prev = reader.sample()
+    prev_t = start
+    try:
+        while True:
+            time.sleep(args.interval)
+            if not os.path.exists(os.path.join("/dev/shm", name.lstrip("/"))):
+                print("Simulation exited")
+                break
+            cur = reader.sample()
+            now = time.monotonic()
+            dt = now - prev_t
+            d = { k : cur[k] - prev[k] for k in cur.keys() }
+            print("%8.1f %7d %10.1f %10.1f %10.1f %9d %10.1f %6.1f%%" % (
+                now - start,
+                cur["actors"],
+                d["evals"] / dt,
+                d["actions_executed"] / dt,
+                d["calls_completed"] / dt,
+                cur["calls_issued"] - cur["calls_completed"],
+                d["solves"] / dt,
+                100.0 * d["solve_ns"] / (dt * 1e9)), flush=True)
+            prev = cur
+            prev_t = now
+    except KeyboardInterrupt:
+        pass
+    reader.close()
+
+def cmd_txn(args):
+    from .txn import TxnReader
+
+    reader = TxnReader(args.file)
+
+    if args.summary:
+        # type name -> [count, total duration, max duration]
+        summary = {}
+        for txn in reader.transactions():
+            s = summary.setdefault(txn.type.name, [0, 0, 0])
+            d = txn.end - txn.start
+            s[0] += 1
+            s[1] += d
+            s[2] = max(s[2], d)
+        print("%-32s %10s %14s %14s" % ("type", "count", "avg time", "max time"))
+        for name in sorted(summary.keys(), key=lambda n: -summary[n][0]):
+            s = summary[name]
+            print("%-32s %10d %14.1f %14d" % (name, s[0], s[1] / s[0], s[2]))
+        return
+
+    for txn in reader.transactions():
+        if args.type is not None and txn.type.name != args.type:
+            continue
+        fields = " ".join("%s=%d" % (k, v) for k, v in txn.fields.items())
+        print("%d actor=%d %s [%d..%d]%s %s" % (
+            txn.id,
+            txn.actor,
+            txn.type.name,
+            txn.start,
+            txn.end,
+            (" parent=%d" % txn.parent) if txn.parent is not None else "",
+            fields))
+
 def getparser():
     parser = argparse.ArgumentParser()
     subparser = parser.add_subparsers()
@@ -73,7 +181,24 @@ def getparser():
     ldpath = subparser.add_parser("ldpath")
     ldpath.set_defaults(func=cmd_ldpath)
     ldflags = subparser.add_parser("ldflags")
+    ldflags.add_argument("--bundle", action="store_true",
+        help="Link against the self-contained zsp-sv-bundle library (fails if it is not installed)")
     ldflags.set_defaults(func=cmd_ldflags)
+    stats = subparser.add_parser("stats",
+        help="Attach to a running simulation and print live statistics")
+    stats.add_argument("name", nargs="?",
+        help="Statistics segment name (default: the only zsp-sv-<pid> segment)")
+    stats.add_argument("-i", "--interval", type=float, default=1.0,
+        help="Sampling interval in seconds")
+    stats.set_defaults(func=cmd_stats)
+    txn = subparser.add_parser("txn",
+        help="Print actions recorded with +zuspec.txn=<path>")
+    txn.add_argument("file", help="Transaction file")
+    txn.add_argument("-t", "--type", 
+        help="Only print transactions of this action type")
+    txn.add_argument("-s", "--summary", action="store_true",
+        help="Print counts and durations by action type")
+    txn.set_defaults(func=cmd_txn)
 
     return parser
 
@@ -0,0 +1,34 @@
+
+cimport zsp_sv.decl as decl
+from libc.stdint cimport int32_t
+from libcpp cimport bool
+
+cdef class ZuspecSv(object):
+    cdef decl.ZuspecSv      *_hndl
+
+    @staticmethod
+    cdef ZuspecSv mk(decl.ZuspecSv *hndl)
+
+cdef class EvalBackend(object):
+    cdef decl.PyEvalBackend *_hndl
+    cdef object             _actor
+
+cdef class EvalThread(object):
+    cdef decl.IEvalThread   *_hndl
+    cdef Actor              _actor
+
+    @staticmethod
+    cdef EvalThread mk(Actor actor, decl.IEvalThread *hndl)
+
+cdef class ValRef(object):
+    cdef decl.ValRef        _val
+
+    @staticmethod
+    cdef ValRef mk(const decl.ValRef &val)
+
+cdef class Actor(object):
+    cdef decl.Actor         *_hndl
+    cdef EvalBackend        _backend
+    cdef bool               _resumed
+    cdef object             _wake
+
@@ -0,0 +1,88 @@
+
+from libc.stdint cimport int32_t, int64_t, uint64_t
+from libcpp cimport bool
+from libcpp.string cimport string as cpp_string
+from libcpp.vector cimport vector as cpp_vector
+cimport cpython.ref as cpy_ref
+
+cdef extern from "vsc/dm/ValRef.h" namespace "vsc::dm":
+    cdef cppclass ValRef:
+        ValRef()
+        ValRef(const ValRef &)
+        bool valid()
+
+cdef extern from "vsc/dm/impl/ValRefInt.h" namespace "vsc::dm":
+    cdef cppclass ValRefInt(ValRef):
+        ValRefInt(const ValRef &)
+        bool is_signed()
+        int32_t bits()
+        uint64_t get_val_u()
+        int64_t get_val_s()
+
+cdef extern from "zsp/arl/dm/IDataTypeFunction.h" namespace "zsp::arl::dm":
+    cdef cppclass IDataTypeFunction:
+        const cpp_string &name()
+
+cdef extern from "zsp/arl/eval/IEvalThread.h" namespace "zsp::arl::eval":
+    cdef cppclass IEvalThread:
+        ValRefInt getAddrHandleValue(const ValRef &)
+
+cdef extern from "zsp/arl/eval/IEvalBackend.h" namespace "zsp::arl::eval":
+    cdef cppclass IEvalBackend:
+        pass
+
+cdef extern from "Actor.h" namespace "zsp::sv":
+    cdef cppclass Actor:
+        int32_t eval() nogil
+        int32_t evalBudget(uint64_t) nogil
+        bool registerFunctionId(const cpp_string &, int32_t)
+        int32_t getFunctionId(IDataTypeFunction *)
+        void setVoidResult(IEvalThread *)
+        void setIntResult(IEvalThread *, int64_t, bool, int32_t)
+        int32_t id()
+
+cdef extern from "Model.h" namespace "zsp::sv":
+    cdef cppclass Model:
+        const cpp_string &name()
+        void loadAsync()
+        bool ensureLoaded()
+
+cdef extern from "ZuspecSv.h" namespace "zsp::sv":
+    cdef cppclass ZuspecSv:
+        bool init(const cpp_string &, bool, bool)
+        bool ensureLoaded()
+        Model *mkModel(const cpp_string &, const cpp_string &)
+        Model *findModel(const cpp_string &)
+        Actor *mkActor(
+            Model *,
+            const cpp_string &,
+            const cpp_string &,
+            const cpp_string &,
+            IEvalBackend *)
+        bool enableStats(const cpp_string &)
+        void report()
+
+    cdef ZuspecSv *ZuspecSv_inst "zsp::sv::ZuspecSv::inst"()
+
+ctypedef void (*PyCallFuncReqF)(
+    cpy_ref.PyObject *,
+    IEvalThread *,
+    IDataTypeFunction *,
+    bool,
+    const cpp_vector[ValRef] *)
+
+ctypedef void (*PyEmitMessageF)(
+    cpy_ref.PyObject *,
+    const char *)
+
+cdef extern from "PyEvalBackend.h" namespace "zsp::sv":
+    cdef cppclass PyEvalBackend(IEvalBackend):
+        PyEvalBackend(cpy_ref.PyObject *)
+        void setActor(Actor *)
+
+    cdef void PyEvalBackend_setCallbacks "zsp::sv::PyEvalBackend::setCallbacks"(
+        PyCallFuncReqF,
+        PyEmitMessageF)
+
+    cdef cpp_string PyDpiHost_takeError()
+
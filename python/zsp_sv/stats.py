@@ -0,0 +1,71 @@
+#****************************************************************************
+#* stats.py
+#*
+#* Copyright 2023 Matthew Ballance and Contributors
+#*
+#* Licensed under the Apache License, Version 2.0 (the "License"); you may 
+#* not use this file except in compliance with the License.  
+#* You may obtain a copy of the License at:
+#*
+#*   http://www.apache.org/licenses/LICENSE-2.0
+#*
+#* Unless required by applicable law or agreed to in writing, software 
+#* distributed under the License is distributed on an "AS IS" BASIS, 
+#* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+#* See the License for the specific language governing permissions and 
+#* limitations under the License.
+#*
+#* Created on:
+#*     Author: 
+#*
+#****************************************************************************
+import mmap
+import os
+import struct
+
+SHM_DIR = "/dev/shm"
+MAGIC = 0x5350535a
+VERSION = 1
+
+# Mirrors ShmStatsBlock in src/StatsShm.h
+FIELDS = [
+    "actors",
+    "evals",
+    "eval_ns",
+    "actions_executed",
+    "calls_issued",
+    "calls_completed",
+    "solves",
+    "solve_ns"
+]
+LAYOUT = struct.Struct("<IIQ" + "Q"*len(FIELDS))
+
+def list_segments():
+    """Returns the names of zsp-sv statistics segments on this host"""
+    if not os.path.isdir(SHM_DIR):
+        return []
+    return sorted(f for f in os.listdir(SHM_DIR) if f.startswith("zsp-sv-"))
+
+class StatsReader(object):
+
+    def __init__(self, name):
+        path = os.path.join(SHM_DIR, name.lstrip("/"))
+        fd = os.open(path, os.O_RDONLY)
+        try:
+            self._mm = mmap.mmap(fd, LAYOUT.size, mmap.MAP_SHARED, mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+        magic, version, self.pid = struct.unpack_from("<IIQ", self._mm, 0)
+        if magic != MAGIC:
+            raise Exception("%s is not a zsp-sv statistics segment" % name)
+        if version != VERSION:
+            raise Exception("Unsupported statistics version %d" % version)
+
+    def sample(self):
+        vals = LAYOUT.unpack_from(self._mm, 0)
+        return dict(zip(FIELDS, vals[3:]))
+
+    def close(self):
+        self._mm.close()
+
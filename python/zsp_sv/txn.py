@@ -0,0 +1,132 @@
+#****************************************************************************
+#* txn.py
+#*
+#* Copyright 2023 Matthew Ballance and Contributors
+#*
+#* Licensed under the Apache License, Version 2.0 (the "License"); you may 
+#* not use this file except in compliance with the License.  
+#* You may obtain a copy of the License at:
+#*
+#*   http://www.apache.org/licenses/LICENSE-2.0
+#*
+#* Unless required by applicable law or agreed to in writing, software 
+#* distributed under the License is distributed on an "AS IS" BASIS, 
+#* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+#* See the License for the specific language governing permissions and 
+#* limitations under the License.
+#*
+#* Created on:
+#*     Author: 
+#*
+#****************************************************************************
+import struct
+
+MAGIC = b"ZSPTXN\0\0"
+VERSION = 1
+
+# Record kinds. Mirrors TxnRecord in src/TxnRecorder.h
+KIND_TYPE = 1
+KIND_BEGIN = 2
+KIND_END = 3
+
+_U8 = struct.Struct("<B")
+_U16 = struct.Struct("<H")
+_U32 = struct.Struct("<I")
+_BEGIN = struct.Struct("<QiIQQ")
+_END = struct.Struct("<QQ")
+
+class TxnType(object):
+
+    def __init__(self, id, name, fields):
+        self.id = id
+        self.name = name
+        # List of (name, width, is_signed)
+        self.fields = fields
+
+class Txn(object):
+
+    def __init__(self, id, actor, type, parent, start, values):
+        self.id = id
+        self.actor = actor
+        self.type = type
+        # Id of the enclosing transaction, or None
+        self.parent = parent
+        self.start = start
+        # None until the action completes
+        self.end = None
+        self.fields = {}
+        for (name, width, is_signed), v in zip(type.fields, values):
+            v &= (1 << width)-1
+            if is_signed and (v >> (width-1)):
+                v -= (1 << width)
+            self.fields[name] = v
+
+class TxnReader(object):
+    """Reads a transaction file written by zsp-sv (+zuspec.txn=<path>)"""
+
+    def __init__(self, path):
+        with open(path, "rb") as fp:
+            self._data = fp.read()
+        if self._data[0:8] != MAGIC:
+            raise Exception("%s is not a zsp-sv transaction file" % path)
+        version, = _U32.unpack_from(self._data, 8)
+        if version != VERSION:
+            raise Exception("Unsupported transaction file version %d" % version)
+        self.types = {}
+
+    def _str(self, off):
+        n, = _U16.unpack_from(self._data, off)
+        off += 2
+        return self._data[off:off+n].decode("utf-8", "replace"), off+n
+
+    def events(self):
+        """Yields ("begin", Txn) and ("end", Txn) in file order. A file
+        from a running or killed simulation may end mid-record; the
+        partial record is ignored"""
+        data = self._data
+        off = 12
+        open_m = {}
+        try:
+            while off < len(data):
+                kind, = _U8.unpack_from(data, off)
+                off += 1
+                if kind == KIND_TYPE:
+                    id, = _U32.unpack_from(data, off)
+                    name, off = self._str(off+4)
+                    n_fields, = _U16.unpack_from(data, off)
+                    off += 2
+                    fields = []
+                    for i in range(n_fields):
+                        f_name, off = self._str(off)
+                        width, is_signed = struct.unpack_from("<BB", data, off)
+                        off += 2
+                        fields.append((f_name, width, is_signed != 0))
+                    self.types[id] = TxnType(id, name, fields)
+                elif kind == KIND_BEGIN:
+                    id, actor, type_id, parent, time = _BEGIN.unpack_from(data, off)
+                    off += _BEGIN.size
+                    type = self.types[type_id]
+                    n = len(type.fields)
+                    values = struct.unpack_from("<%dQ" % n, data, off)
+                    off += 8*n
+                    txn = Txn(id, actor, type, 
+                        parent-1 if parent != 0 else None, time, values)
+                    open_m[id] = txn
+                    yield ("begin", txn)
+                elif kind == KIND_END:
+                    id, time = _END.unpack_from(data, off)
+                    off += _END.size
+                    txn = open_m.pop(id, None)
+                    if txn is not None:
+                        txn.end = time
+                        yield ("end", txn)
+                else:
+                    raise Exception("Invalid record kind %d at offset %d" % (kind, off-1))
+        except struct.error:
+            pass
+
+    def transactions(self):
+        """Yields each transaction once it completes"""
+        for ev, txn in self.events():
+            if ev == "end":
+                yield txn
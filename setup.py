@@ -26,25 +26,35 @@ except ImportError as e:
     print("Failed to load IVPM: %s" % str(e))
 
 zuspec_sv_dir = proj_dir
+packages_dir = os.path.join(proj_dir, "packages")
 
 ext = Extension("zsp_sv.core",
             sources=[
                 os.path.join(zuspec_sv_dir, 'python', "core.pyx"), 
+                os.path.join(zuspec_sv_dir, 'python', "PyEvalBackend.cpp"), 
             ],
             language="c++",
             include_dirs=[
-#                os.path.join(zuspec_sv_dir, 'src'),
+                os.path.join(zuspec_sv_dir, 'src'),
                 os.path.join(zuspec_sv_dir, 'python'),
                 os.path.join(zuspec_sv_dir, 'src', 'include'),
-                # os.path.join(packages_dir, 'vsc-dm', 'src', 'include'),
-                # os.path.join(packages_dir, 'vsc-dm', 'python'),
-                # os.path.join(packages_dir, 'vsc-solvers', 'src', 'include'),
-                # os.path.join(packages_dir, 'vsc-solvers', 'python'),
-                # os.path.join(packages_dir, 'zuspec-arl-dm', 'src', 'include'),
-                # os.path.join(packages_dir, 'zuspec-arl-dm', 'python'),
-                # os.path.join(packages_dir, 'debug-mgr', 'src', 'include'),
-                # os.path.join(packages_dir, 'debug-mgr', 'python'),
-            ]
+                os.path.join(packages_dir, 'vsc-dm', 'src', 'include'),
+                os.path.join(packages_dir, 'vsc-dm', 'python'),
+                os.path.join(packages_dir, 'vsc-solvers', 'src', 'include'),
+                os.path.join(packages_dir, 'vsc-solvers', 'python'),
+                os.path.join(packages_dir, 'zuspec-arl-dm', 'src', 'include'),
+                os.path.join(packages_dir, 'zuspec-arl-dm', 'python'),
+                os.path.join(packages_dir, 'debug-mgr', 'src', 'include'),
+                os.path.join(packages_dir, 'debug-mgr', 'python'),
+                os.path.join(packages_dir, 'zuspec-arl-eval', 'src', 'include'),
+                os.path.join(packages_dir, 'zuspec-arl-eval', 'python'),
+            ],
+            library_dirs=[
+                os.path.join(zuspec_sv_dir, 'build', 'lib'),
+                os.path.join(zuspec_sv_dir, 'build', 'lib64'),
+            ],
+            libraries=["zsp-sv"],
+            runtime_library_dirs=["$ORIGIN"]
         )
 ext.cython_directives={'language_level' : '3'}
 
@@ -82,7 +92,9 @@ setup_args = dict(
 )
 
 if isSrcBuild:
-    setup_args["ivpm_extdep_pkgs"] = ["zuspec-parser", "zuspec-fe-parser", "zuspec-arl-eval"]
+    setup_args["ivpm_extdep_pkgs"] = [
+        "debug-mgr", "vsc-dm", "vsc-solvers", "zuspec-arl-dm",
+        "zuspec-parser", "zuspec-fe-parser", "zuspec-arl-eval"]
     setup_args["ivpm_extra_data"] = {
         "zsp_sv": [
             ("src/include", "share"),
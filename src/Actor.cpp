@@ -18,36 +18,110 @@
  * Created on:
  *     Author:
  */
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
 #include "Actor.h"
+#include "Probes.h"
+#include "SimTime.h"
+#include "StatsShm.h"
+#include "TaskFindActivityRepeat.h"
+#include "ZuspecSvDpiImp.h"
+#include "vsc/dm/IDataTypeInt.h"
 #include "vsc/solvers/FactoryExt.h"
 #include "zsp/arl/eval/FactoryExt.h"
 
-typedef void *chandle;
-
 namespace zsp {
 namespace sv {
 
 
+static std::string actor_name(int32_t id) {
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "actor %d", id);
+    return tmp;
+}
+
 Actor::Actor(
-        arl::dm::IContext               *ctxt,
+        int32_t                         id,
+        Model                           *model,
         const std::string               &seed,
         arl::dm::IDataTypeComponent     *comp_t,
         arl::dm::IDataTypeAction        *action_t,
-        arl::eval::IEvalBackend         *backend) {
+        arl::eval::IEvalBackend         *backend,
+        bool                            journal) :
+            m_id(id), m_heap(HeapProf::mkScope(actor_name(id))),
+            m_solver_f(vsc_solvers_getFactory()), m_txn(0),
+            m_act_ev_en(false), m_n_actions(0), m_call_track(false),
+            m_call_timeout_fatal(false),
+            m_call_stats_valid(false), m_act_ev_rd(0),
+            m_model(model), m_ctxt(model->ctxt()), m_comp_t(comp_t), m_action_t(action_t),
+            m_backend(backend), m_journal_en(journal), m_started(false),
+            m_budget_warned(false), m_mem(0), m_mem_mode(MemMode::Functional),
+            m_ctxt_backend(backend) {
+    m_budget.timed = false;
+    m_budget.step_limit = 0;
+    m_budget.steps = 0;
+    m_budget.yielded = false;
+    build(seed);
+}
+
+Actor::~Actor() {
+    // The worker must be idle before the contexts are destroyed
+    if (m_async) {
+        m_async->stop();
+    }
+}
+
+void Actor::build(const std::string &seed) {
+    HeapScope heap_s(m_heap);
     arl::eval::IFactory *eval_f = zsp_arl_eval_getFactory();
-    vsc::solvers::IFactory *solvers_f = vsc_solvers_getFactory();
 
-    m_randstate = vsc::solvers::IRandStateUP(solvers_f->mkRandState(seed));
+    m_evalCtxt.reset();
+    if (m_stream) {
+        m_stream->active.clear();
+        m_stream->started = 0;
+    }
+    m_open_m.clear();
+    m_calls.clear();
+    m_act_ev.clear();
+    m_act_ev_rd = 0;
+    releaseCallParams();
+    m_func_m.clear();
+    // Table hits don't consume the random state as solves do, so a new
+    // context (eg one being restored) must start from empty tables
+    m_solver_f.clearSolutionTables();
+
+    m_seed = seed;
+    m_ctxt_backend = m_backend;
+    if (m_async) {
+        m_ctxt_backend = m_async.get();
+    }
+    m_mem_be.reset();
+    if (m_mem) {
+        m_mem_be = SparseMemBackendUP(new SparseMemBackend(
+            this, m_ctxt_backend, m_mem, m_mem_mode));
+        m_ctxt_backend = m_mem_be.get();
+    }
+    if (m_journal_en) {
+        m_journal = ActorJournalUP(new ActorJournal(this, m_ctxt_backend));
+        m_journal->setSeed(seed);
+        m_ctxt_backend = m_journal.get();
+    }
+
+    m_randstate = vsc::solvers::IRandStateUP(m_solver_f.mkRandState(seed));
 
-    m_evalCtxt = arl::eval::IEvalContextUP(
-        eval_f->mkEvalContextFullElab(
-            vsc_solvers_getFactory(),
-            ctxt,
-            m_randstate.get(),
-            0, // TODO: pyeval
-            comp_t,
-            action_t,
-            backend));
+    {
+        std::lock_guard<std::mutex> lock(m_model->elabMutex());
+        m_evalCtxt = arl::eval::IEvalContextUP(
+            eval_f->mkEvalContextFullElab(
+                &m_solver_f,
+                m_ctxt,
+                m_randstate.get(),
+                0, // TODO: pyeval
+                m_comp_t,
+                m_action_t,
+                m_ctxt_backend));
+    }
 
     for (std::vector<arl::dm::IDataTypeFunction *>::const_iterator
         it=m_evalCtxt->getSolveFunctions().begin();
@@ -60,16 +134,241 @@ Actor::Actor(
         m_func_m.insert({(*it)->name(), *it});
     }
 
+    // When the root action is streamed, the up-front context is only
+    // needed for the function lists above
+    if (m_stream) {
+        m_evalCtxt.reset();
+    }
 }
 
-Actor::~Actor() {
+int32_t Actor::eval() {
+    return evalLimited(0, 0);
+}
+
+int32_t Actor::evalBudget(uint64_t max_us) {
+    char tmp[256];
+
+    // Evaluation can only yield between iteration contexts, and a single
+    // context runs until it blocks. A budget is valid for any actor, so
+    // other actors run without one and note that once
+    if (max_us && !m_stream) {
+        if (!m_budget_warned) {
+            snprintf(tmp, sizeof(tmp),
+                "WARNING: Actor %d: an evaluation budget only applies between "
+                "the iterations of a streamed actor, and is ignored. Use "
+                "set_async to keep simulation time advancing during long "
+                "solves", m_id);
+            zuspec_message(tmp);
+            m_budget_warned = true;
+        }
+        max_us = 0;
+    }
 
+    return evalLimited(max_us, 0);
 }
 
-int32_t Actor::eval() {
+int32_t Actor::evalSteps(int64_t steps) {
+    return evalLimited(0, steps);
+}
+
+int32_t Actor::evalLimited(uint64_t max_us, int64_t steps) {
+    HeapScope heap_s(m_heap);
+    uint64_t ev_idx = 0;
+    if (m_journal) {
+        ev_idx = m_journal->recordEval();
+    }
+    ShmStatsBlock *shm = StatsShm::block();
+    ZSP_SV_PROBE1(actor_eval_enter, m_id);
+
+    m_started = true;
+
+    // Evaluation may nest (eg replay from within a call), so the 
+    // enclosing evaluation's budget is saved
+    Budget prev_budget = m_budget;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    m_budget.timed = (max_us != 0);
+    m_budget.deadline = start + std::chrono::microseconds(max_us);
+    m_budget.step_limit = steps;
+    m_budget.steps = 0;
+    m_budget.yielded = false;
+
+    int32_t ret = evalRoot();
+
+    if (m_budget.yielded) {
+        // Replay must yield at the same point to reproduce this step
+        if (m_journal) {
+            m_journal->setEvalSteps(ev_idx, m_budget.steps);
+        }
+        ret = 2;
+    }
+    m_budget = prev_budget;
+
+    if (shm) {
+        shm->evals.fetch_add(1, std::memory_order_relaxed);
+        shm->eval_ns.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count(),
+            std::memory_order_relaxed);
+    }
+    ZSP_SV_PROBE2(actor_eval_exit, m_id, ret);
+    return ret;
+}
+
+bool Actor::budgetExhausted() {
+    // At least one step is always taken, so evaluation progresses
+    if (m_budget.yielded) {
+        return true;
+    } else if (!m_budget.steps) {
+        return false;
+    } else if (m_budget.step_limit) {
+        m_budget.yielded = (m_budget.steps >= m_budget.step_limit);
+    } else if (m_budget.timed) {
+        m_budget.yielded = (std::chrono::steady_clock::now() >= m_budget.deadline);
+    }
+    return m_budget.yielded;
+}
+
+int32_t Actor::evalRoot() {
+    if (m_stream) {
+        return evalStream();
+    }
+
+    m_budget.steps++;
     return m_evalCtxt->eval();
 }
 
+int32_t Actor::evalStream() {
+    arl::eval::IFactory *eval_f = zsp_arl_eval_getFactory();
+    bool retired;
+
+    // Keep the window full. Iterations execute in sequence: only the 
+    // oldest runs, and the others are elaborated (solved) ahead of it. 
+    // Iterations that complete without blocking are retired immediately,
+    // making room for the next
+    do {
+        retired = false;
+        while (m_stream->active.size() < m_stream->window
+            && (!m_stream->count || m_stream->started < m_stream->count)
+            && !budgetExhausted()) {
+            m_budget.steps++;
+            IterationUP it(new Iteration());
+            it->randstate = vsc::solvers::IRandStateUP(m_randstate->next());
+            // Other actors of the model may be elaborating concurrently
+            std::lock_guard<std::mutex> lock(m_model->elabMutex());
+            it->ctxt = arl::eval::IEvalContextUP(
+                eval_f->mkEvalContextFullElab(
+                    &m_solver_f,
+                    m_ctxt,
+                    it->randstate.get(),
+                    0,
+                    m_comp_t,
+                    m_action_t,
+                    m_ctxt_backend));
+            m_stream->active.push_back(std::move(it));
+            m_stream->started++;
+        }
+
+        while (m_stream->active.size() && !budgetExhausted()) {
+            m_budget.steps++;
+            if (m_stream->active.front()->ctxt->eval()) {
+                break;
+            }
+            m_stream->active.pop_front();
+            retired = true;
+        }
+    } while (retired && !m_budget.yielded);
+
+    return (m_stream->active.size() || m_budget.yielded)?1:0;
+}
+
+bool Actor::setStreaming(uint64_t count, uint32_t window) {
+    char tmp[1024];
+
+    if (m_started) {
+        zuspec_error("setStreaming must be called before the actor is evaluated");
+        return false;
+    }
+
+    // Each iteration is elaborated as a whole, so a repeat in the root 
+    // activity would still grow memory with its count
+    {
+        std::lock_guard<std::mutex> lock(m_model->elabMutex());
+        if (TaskFindActivityRepeat().find(m_action_t)) {
+            snprintf(tmp, sizeof(tmp),
+                "Actor %d: cannot stream %s, whose activity contains a repeat. "
+                "Streaming runs iterations of a root action without repeat "
+                "or forever loops", m_id, m_action_t->name().c_str());
+            zuspec_error(tmp);
+            return false;
+        }
+    }
+
+    if (!m_stream) {
+        m_stream = StreamUP(new Stream());
+        m_stream->started = 0;
+    }
+    m_stream->count = count;
+    m_stream->window = (window)?window:1;
+    m_evalCtxt.reset();
+
+    return true;
+}
+
+bool Actor::setAsync(bool en) {
+    if (m_started) {
+        zuspec_error("setAsync must be called before the actor is evaluated");
+        return false;
+    }
+
+    if (en == (m_async != 0)) {
+        return true;
+    }
+
+    // The contexts must be rebuilt to route calls through the worker
+    if (m_async) {
+        m_async->stop();
+    }
+    m_evalCtxt.reset();
+    if (m_stream) {
+        m_stream->active.clear();
+    }
+    m_journal.reset();
+    m_async = (en)?AsyncEvalUP(new AsyncEval(this, m_backend)):AsyncEvalUP();
+    build(m_seed);
+
+    return true;
+}
+
+bool Actor::setMem(SparseMem *mem, MemMode mode) {
+    if (m_started) {
+        zuspec_error("setMem must be called before the actor is evaluated");
+        return false;
+    }
+
+    // The contexts must be rebuilt to route calls through the memory
+    m_evalCtxt.reset();
+    if (m_stream) {
+        m_stream->active.clear();
+    }
+    m_journal.reset();
+    m_mem = mem;
+    m_mem_mode = mode;
+    build(m_seed);
+
+    return true;
+}
+
+std::string Actor::setupSignature() const {
+    char tmp[64] = "";
+
+    if (m_stream) {
+        snprintf(tmp, sizeof(tmp), "streamed:%llu:%u",
+            (unsigned long long)m_stream->count, m_stream->window);
+    }
+
+    return tmp;
+}
+
 bool Actor::registerFunctionId(const std::string &name, int32_t id) {
     std::map<std::string, arl::dm::IDataTypeFunction *>::const_iterator it;
 
@@ -83,6 +382,478 @@ bool Actor::registerFunctionId(const std::string &name, int32_t id) {
     }
 }
 
+void Actor::setVoidResult(arl::eval::IEvalThread *thread) {
+    if (m_async) {
+        m_async->postVoidResult(thread);
+    } else {
+        applyVoidResult(thread);
+    }
+}
+
+void Actor::setIntResult(
+        arl::eval::IEvalThread  *thread,
+        int64_t                 value,
+        bool                    is_signed,
+        int32_t                 width) {
+    if (m_async) {
+        m_async->postIntResult(thread, value, is_signed, width);
+    } else {
+        applyIntResult(thread, value, is_signed, width);
+    }
+}
+
+void Actor::applyVoidResult(arl::eval::IEvalThread *thread) {
+    ZSP_SV_PROBE2(thread_set_void_result, m_id, thread);
+    if (m_journal) {
+        m_journal->recordResult(thread, JournalEvent::VoidResult);
+    }
+    if (m_call_track) {
+        callResult(thread);
+    }
+    callComplete(thread);
+    thread->setFlags(arl::eval::EvalFlags::Complete);
+}
+
+void Actor::applyIntResult(
+        arl::eval::IEvalThread  *thread,
+        int64_t                 value,
+        bool                    is_signed,
+        int32_t                 width) {
+    ZSP_SV_PROBE3(thread_set_int_result, m_id, thread, value);
+    if (m_journal) {
+        m_journal->recordResult(
+            thread, JournalEvent::IntResult, value, is_signed, width);
+    }
+    if (m_mem_be) {
+        m_mem_be->intResult(thread, value);
+    }
+    if (m_call_track) {
+        callResult(thread);
+    }
+    callComplete(thread);
+    thread->setResult(thread->mkValRefInt(value, is_signed, width));
+}
+
+void Actor::reseed(const std::string &seed) {
+    vsc::solvers::IRandStateUP state(m_solver_f.mkRandState(seed));
+    m_randstate->setState(state.get());
+    if (m_journal) {
+        m_journal->recordReseed(seed);
+    }
+}
+
+bool Actor::save(const std::string &path) {
+    char tmp[1024];
+
+    if (!m_journal) {
+        zuspec_error("Actor checkpointing requires +zuspec.checkpoint");
+        return false;
+    }
+
+    if (m_mem) {
+        // The memory is shared between actors and isn't part of the
+        // journal, and replayed accesses don't reach it
+        snprintf(tmp, sizeof(tmp),
+            "Cannot checkpoint actor %d: checkpointing is not supported with +zuspec.mem",
+            m_id);
+        zuspec_error(tmp);
+        return false;
+    }
+
+    if (m_async && m_async->busy()) {
+        snprintf(tmp, sizeof(tmp), 
+            "Cannot checkpoint actor %d while it is evaluating", m_id);
+        zuspec_error(tmp);
+        return false;
+    }
+
+    if (m_journal->numOutstanding()) {
+        snprintf(tmp, sizeof(tmp), 
+            "Cannot checkpoint actor %d with %d outstanding calls",
+            m_id, m_journal->numOutstanding());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    return m_journal->save(
+        path, m_comp_t->name(), m_action_t->name(), setupSignature());
+}
+
+bool Actor::restore(const std::string &path, const std::string &seed) {
+    char tmp[1024];
+
+    if (!m_journal) {
+        zuspec_error("Actor checkpointing requires +zuspec.checkpoint");
+        return false;
+    }
+
+    if (m_mem) {
+        snprintf(tmp, sizeof(tmp),
+            "Cannot restore actor %d: checkpointing is not supported with +zuspec.mem",
+            m_id);
+        zuspec_error(tmp);
+        return false;
+    }
+
+    if (m_async && m_async->busy()) {
+        snprintf(tmp, sizeof(tmp), 
+            "Cannot restore actor %d while it is evaluating", m_id);
+        zuspec_error(tmp);
+        return false;
+    }
+
+    if (m_journal->numOutstanding()) {
+        snprintf(tmp, sizeof(tmp), 
+            "Cannot restore actor %d with %d outstanding calls",
+            m_id, m_journal->numOutstanding());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    ActorJournal src(this, m_backend);
+    if (!src.load(path, m_comp_t->name(), m_action_t->name(), setupSignature())) {
+        return false;
+    }
+
+    build(src.seed());
+
+    if (!m_journal->replay(&src)) {
+        return false;
+    }
+
+    if (seed != "") {
+        reseed(seed);
+    }
+
+    return true;
+}
+
+void Actor::callIssued(
+        arl::eval::IEvalThread          *thread,
+        arl::dm::IDataTypeFunction      *func_t) {
+    ZSP_SV_PROBE4(call_func_req,
+        m_id,
+        getFunctionId(func_t),
+        thread,
+        !func_t->hasFlags(arl::dm::DataTypeFunctionFlags::Solve));
+    // Only target calls wait on the environment. Solve-time functions 
+    // complete within the solve, so have no latency to track
+    if (m_call_track && !func_t->hasFlags(arl::dm::DataTypeFunctionFlags::Solve)) {
+        m_calls[thread] = {func_t, SimTime::get(), getCallTimeout(func_t), false};
+    }
+    ShmStatsBlock *shm = StatsShm::block();
+    if (shm) {
+        shm->calls_issued.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // A thread has at most one outstanding call
+    ArenaUP &params = m_call_param_m[thread];
+    if (params) {
+        char tmp[256];
+        snprintf(tmp, sizeof(tmp),
+            "Actor %d: call to %s issued on a thread whose previous call "
+            "was not completed", m_id, func_t->name().c_str());
+        callError(tmp);
+        params->reset();
+    } else if (m_call_param_free.size()) {
+        params = std::move(m_call_param_free.back());
+        m_call_param_free.pop_back();
+    } else {
+        params = ArenaUP(new Arena(1024));
+    }
+}
+
+void Actor::actionStart(
+        arl::eval::IEvalThread          *thread,
+        arl::dm::IDataTypeAction        *action_t,
+        const vsc::dm::ValRef           &action_v) {
+    if (!m_txn && !m_act_ev_en) {
+        return;
+    }
+
+    std::vector<OpenAction> &open = m_open_m[thread];
+    OpenAction action = {m_n_actions++, 0};
+
+    if (m_txn) {
+        uint64_t parent = (open.size())?open.back().txn+1:0;
+        action.txn = m_txn->begin(m_id, action_t, action_v, parent);
+    }
+    if (m_act_ev_en) {
+        queueActionEvent(ActionEvent::Start, action.id, action_t, action_v);
+    }
+    open.push_back(action);
+}
+
+void Actor::actionComplete(
+        arl::eval::IEvalThread          *thread,
+        arl::dm::IDataTypeAction        *action_t,
+        const vsc::dm::ValRef           &action_v) {
+    ShmStatsBlock *shm = StatsShm::block();
+    if (shm) {
+        shm->actions_executed.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (m_cov) {
+        m_cov->sample(action_t, action_v);
+    }
+
+    std::unordered_map<arl::eval::IEvalThread *, std::vector<OpenAction>>::iterator it;
+    if ((it=m_open_m.find(thread)) != m_open_m.end()) {
+        const OpenAction &action = it->second.back();
+        if (m_txn) {
+            m_txn->end(action.txn);
+        }
+        if (m_act_ev_en) {
+            queueActionEvent(ActionEvent::End, action.id, action_t, action_v);
+        }
+        it->second.pop_back();
+        if (!it->second.size()) {
+            m_open_m.erase(it);
+        }
+    }
+}
+
+uint32_t Actor::drainActionEvents(uint64_t *buf, uint32_t max) {
+    std::lock_guard<std::mutex> lock(m_ev_mutex);
+    uint32_t n = 0;
+
+    while (m_act_ev_rd < m_act_ev.size()) {
+        uint32_t sz = 2 + (m_act_ev.at(m_act_ev_rd) & 0xFFFFFFFF);
+        if (n + sz > max) {
+            break;
+        }
+        memcpy(&buf[n], &m_act_ev.at(m_act_ev_rd), sizeof(uint64_t)*sz);
+        m_act_ev_rd += sz;
+        n += sz;
+    }
+
+    // Storage is kept for the next batch
+    if (m_act_ev_rd == m_act_ev.size()) {
+        m_act_ev.clear();
+        m_act_ev_rd = 0;
+    }
+
+    return n;
+}
+
+const std::string &Actor::getActionTypeName(uint32_t id) const {
+    static const std::string empty;
+    std::lock_guard<std::mutex> lock(m_ev_mutex);
+    return (id < m_act_types.size())?m_act_types.at(id)->name():empty;
+}
+
+const Actor::ActionType &Actor::getActionType(arl::dm::IDataTypeAction *action_t) {
+    std::unordered_map<arl::dm::IDataTypeAction *, ActionType>::const_iterator it;
+
+    if ((it=m_act_type_m.find(action_t)) != m_act_type_m.end()) {
+        return it->second;
+    }
+
+    ActionType &type = m_act_type_m[action_t];
+    type.id = m_act_types.size();
+    m_act_types.push_back(action_t);
+
+    for (uint32_t i=0; 
+        i<action_t->getFields().size() && type.fields.size()<ActionEvent::MAX_FIELDS; 
+        i++) {
+        vsc::dm::IDataTypeInt *field_t = dynamic_cast<vsc::dm::IDataTypeInt *>(
+            action_t->getFields().at(i)->getDataType());
+        if (field_t && field_t->width() > 0 && field_t->width() <= 64) {
+            type.fields.push_back(i);
+        }
+    }
+
+    return type;
+}
+
+void Actor::queueActionEvent(
+        ActionEvent::Kind               kind,
+        uint64_t                        id,
+        arl::dm::IDataTypeAction        *action_t,
+        const vsc::dm::ValRef           &action_v) {
+    std::unique_lock<std::mutex> lock(m_ev_mutex, std::defer_lock);
+    if (m_async) {
+        lock.lock();
+    }
+    const ActionType &type = getActionType(action_t);
+
+    m_act_ev.push_back(
+        (uint64_t(kind) << 62) 
+        | (uint64_t(type.id & 0x3FFFFFFF) << 32) 
+        | type.fields.size());
+    m_act_ev.push_back(id);
+
+    vsc::dm::ValRefStruct val_s(action_v);
+    for (std::vector<int32_t>::const_iterator
+        it=type.fields.begin();
+        it!=type.fields.end(); it++) {
+        vsc::dm::ValRefInt val(val_s.getFieldRef(*it));
+        m_act_ev.push_back(val.get_val_u());
+    }
+}
+
+void Actor::callResult(arl::eval::IEvalThread *thread) {
+    std::unordered_map<arl::eval::IEvalThread *, OutstandingCall>::iterator it;
+
+    if ((it=m_calls.find(thread)) == m_calls.end()) {
+        return;
+    }
+
+    uint64_t now = SimTime::get();
+    {
+        std::unique_lock<std::mutex> lock(m_ev_mutex, std::defer_lock);
+        if (m_async) {
+            lock.lock();
+        }
+        m_call_stats[it->second.func_t].record(
+            (now > it->second.issued)?(now - it->second.issued):0);
+        m_call_stats_valid = false;
+    }
+    m_calls.erase(it);
+}
+
+void Actor::setCallTimeout(const std::string &func, uint64_t timeout) {
+    m_call_timeout_m[func] = timeout;
+    m_call_timeout_fm.clear();
+    m_call_track = true;
+}
+
+uint64_t Actor::getCallTimeout(arl::dm::IDataTypeFunction *func_t) {
+    std::unordered_map<arl::dm::IDataTypeFunction *, uint64_t>::const_iterator it;
+
+    if ((it=m_call_timeout_fm.find(func_t)) != m_call_timeout_fm.end()) {
+        return it->second;
+    }
+
+    std::map<std::string, uint64_t>::const_iterator t_it;
+    uint64_t timeout = 0;
+    if ((t_it=m_call_timeout_m.find(func_t->name())) != m_call_timeout_m.end()
+        || (t_it=m_call_timeout_m.find("*")) != m_call_timeout_m.end()) {
+        timeout = t_it->second;
+    }
+    m_call_timeout_fm.insert({func_t, timeout});
+
+    return timeout;
+}
+
+uint64_t Actor::getMinCallTimeout() const {
+    uint64_t ret = 0;
+
+    for (std::map<std::string, uint64_t>::const_iterator
+        it=m_call_timeout_m.begin();
+        it!=m_call_timeout_m.end(); it++) {
+        if (it->second && (!ret || it->second < ret)) {
+            ret = it->second;
+        }
+    }
+
+    return ret;
+}
+
+int32_t Actor::checkCallTimeouts() {
+    char tmp[1024];
+    uint64_t now = SimTime::get();
+    int32_t ret = 0;
+
+    // Calls are only touched by the worker while it evaluates
+    if (m_async && m_async->busy()) {
+        return 0;
+    }
+
+    for (std::unordered_map<arl::eval::IEvalThread *, OutstandingCall>::iterator
+        it=m_calls.begin();
+        it!=m_calls.end(); it++) {
+        OutstandingCall &call = it->second;
+        uint64_t elapsed = (now > call.issued)?(now - call.issued):0;
+        if (call.reported || !call.timeout || elapsed < call.timeout) {
+            continue;
+        }
+        call.reported = true;
+        {
+            std::unique_lock<std::mutex> lock(m_ev_mutex, std::defer_lock);
+            if (m_async) {
+                lock.lock();
+            }
+            m_call_stats[call.func_t].timeouts++;
+            m_call_stats_valid = false;
+        }
+        snprintf(tmp, sizeof(tmp),
+            "Actor %d: call to %s outstanding for %llu (dispatched at %llu, timeout %llu)",
+            m_id, call.func_t->name().c_str(),
+            (unsigned long long)elapsed,
+            (unsigned long long)call.issued,
+            (unsigned long long)call.timeout);
+        if (m_call_timeout_fatal) {
+            zuspec_fatal(tmp);
+        } else {
+            zuspec_error(tmp);
+        }
+        ret++;
+    }
+
+    return ret;
+}
+
+std::map<std::string, CallStats> Actor::getCallStats() const {
+    std::lock_guard<std::mutex> lock(m_ev_mutex);
+    std::map<std::string, CallStats> ret;
+
+    for (std::unordered_map<arl::dm::IDataTypeFunction *, CallStats>::const_iterator
+        it=m_call_stats.begin();
+        it!=m_call_stats.end(); it++) {
+        ret[it->first->name()].add(it->second);
+    }
+
+    return ret;
+}
+
+const std::vector<std::pair<std::string, CallStats>> &Actor::getCallStatsList() {
+    // Statistics updated while the list is rebuilt invalidate it again
+    if (!m_call_stats_valid.exchange(true)) {
+        std::map<std::string, CallStats> stats = getCallStats();
+        m_call_stats_l.assign(stats.begin(), stats.end());
+    }
+    return m_call_stats_l;
+}
+
+void Actor::callComplete(arl::eval::IEvalThread *thread) {
+    std::unordered_map<arl::eval::IEvalThread *, ArenaUP>::iterator it;
+    if ((it=m_call_param_m.find(thread)) != m_call_param_m.end()) {
+        it->second->reset();
+        m_call_param_free.push_back(std::move(it->second));
+        m_call_param_m.erase(it);
+    } else if (!m_journal || !m_journal->replaying()) {
+        // Replayed calls are answered by the journal, and never issued
+        char tmp[256];
+        snprintf(tmp, sizeof(tmp),
+            "Actor %d: result set for a thread with no outstanding call", m_id);
+        callError(tmp);
+    }
+    ShmStatsBlock *shm = StatsShm::block();
+    if (shm) {
+        shm->calls_completed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Actor::callError(const char *msg) {
+    // Async actors issue and complete calls on the worker thread, which 
+    // must not call into the simulator
+    if (m_async) {
+        m_async->postError(msg);
+    } else {
+        zuspec_error(msg);
+    }
+}
+
+void Actor::releaseCallParams() {
+    for (std::unordered_map<arl::eval::IEvalThread *, ArenaUP>::iterator
+        it=m_call_param_m.begin();
+        it!=m_call_param_m.end(); it++) {
+        it->second->reset();
+        m_call_param_free.push_back(std::move(it->second));
+    }
+    m_call_param_m.clear();
+}
+
 int32_t Actor::getFunctionId(arl::dm::IDataTypeFunction *f) {
     std::map<arl::dm::IDataTypeFunction *, int32_t>::const_iterator it;
 
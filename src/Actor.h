@@ -19,38 +19,480 @@
  *     Author: 
  */
 #pragma once
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "vsc/solvers/IRandState.h"
+#include "ActorCoverage.h"
+#include "ActorJournal.h"
+#include "CallStats.h"
+#include "Arena.h"
+#include "AsyncEval.h"
+#include "HeapProf.h"
+#include "Model.h"
+#include "SolverFactoryProxy.h"
+#include "SparseMemBackend.h"
+#include "TxnRecorder.h"
 #include "zsp/arl/dm/IDataTypeAction.h"
 #include "zsp/arl/dm/IDataTypeComponent.h"
 #include "zsp/arl/eval/IEvalBackend.h"
 #include "zsp/arl/eval/IEvalContext.h"
+#include "zsp/sv/IActor.h"
 
 namespace zsp {
 namespace sv {
 
 
 
-class Actor {
+/**
+ * Action start/end events queued for SV. Each event is a sequence of
+ * 64-bit words: a header, the actor-local id of the action instance, 
+ * then the value of each integer field of the action (up to 64 bits, 
+ * in declaration order, at most MAX_FIELDS)
+ *
+ * header: [63:62] kind, [61:32] action type id, [31:0] number of fields
+ */
+struct ActionEvent {
+    static const uint32_t MAX_FIELDS = 62;
+    // Largest event, in words
+    static const uint32_t MAX_WORDS = MAX_FIELDS+2;
+
+    enum Kind : uint64_t {
+        Start = 1,
+        End = 2
+    };
+};
+
+class Actor : public virtual IActor {
 public:
     Actor(
-        arl::dm::IContext               *ctxt,
+        int32_t                         id,
+        Model                           *model,
         const std::string               &seed,
         arl::dm::IDataTypeComponent     *comp_t,
         arl::dm::IDataTypeAction        *action_t,
-        arl::eval::IEvalBackend         *backend
+        arl::eval::IEvalBackend         *backend,
+        bool                            journal=false
     );
 
     virtual ~Actor();
 
-    int32_t eval();
+    virtual int32_t eval() override;
+
+    virtual int32_t evalBudget(uint64_t max_us) override;
+
+    /**
+     * Evaluates for at most 'steps' context evaluations. Used to replay
+     * a budgeted evaluation that yielded
+     */
+    int32_t evalSteps(int64_t steps);
 
     bool registerFunctionId(const std::string &name, int32_t id);
 
     int32_t getFunctionId(arl::dm::IDataTypeFunction *f);
 
+    /**
+     * Called by the backend when it issues a call to the environment.
+     * Assigns the call a parameter pool, released when the call completes
+     */
+    void callIssued(arl::eval::IEvalThread *thread, arl::dm::IDataTypeFunction *func_t);
+
+    /**
+     * Called by the backend when an action starts
+     */
+    void actionStart(
+        arl::eval::IEvalThread          *thread,
+        arl::dm::IDataTypeAction        *action_t,
+        const vsc::dm::ValRef           &action_v);
+
+    /**
+     * Called by the backend when an action completes
+     */
+    void actionComplete(
+        arl::eval::IEvalThread          *thread,
+        arl::dm::IDataTypeAction        *action_t,
+        const vsc::dm::ValRef           &action_v);
+
+    /**
+     * Samples automatic coverage of completed actions into 'db'
+     */
+    void setCoverage(CovDb *db) {
+        m_cov = ActorCoverageUP((db)?new ActorCoverage(db):0);
+    }
+
+    /**
+     * Serves (Functional) or checks (Shadow) the actor's addr_reg_pkg
+     * memory reads and writes with 'mem'. Must be called before the 
+     * first eval()
+     */
+    bool setMem(SparseMem *mem, MemMode mode);
+
+    /**
+     * Records executed actions to 'rec'
+     */
+    void setRecorder(TxnRecorder *rec) {
+        m_txn = rec;
+    }
+
+    /**
+     * Queues action start/end events for delivery to SV in batches
+     */
+    void setActionEvents(bool en) {
+        m_act_ev_en = en;
+    }
+
+    /**
+     * Copies queued action events to 'buf', up to 'max' words. Only whole
+     * events are copied, so 'max' must be at least ActionEvent::MAX_WORDS.
+     * Returns the number of words copied
+     */
+    uint32_t drainActionEvents(uint64_t *buf, uint32_t max);
+
+    /**
+     * Returns the name of an action type referenced by an action event
+     */
+    const std::string &getActionTypeName(uint32_t id) const;
+
+    /**
+     * Steers solves of covered action types toward unhit coverage bins
+     * by keeping the best of 'k' solutions. Counts from 'prior', a 
+     * database merged from earlier runs, are added to those of this run.
+     * Requires that coverage is enabled
+     */
+    bool setCoverageFeedback(uint32_t k, const CovDb *prior) {
+        if (!m_cov) {
+            return false;
+        }
+        m_cov->setPrior(prior);
+        m_solver_f.setCoverageBias((k > 1)?m_cov.get():0, k);
+        return true;
+    }
+
+    /**
+     * Returns the parameter pool of the thread's outstanding call, which
+     * holds the call's parameter list and call object. Valid from 
+     * callIssued() until the call's result is applied. Temporaries of 
+     * the evaluation context itself (action instances, solved fields) 
+     * are allocated by arl-eval and don't use it
+     */
+    Arena &callParams(arl::eval::IEvalThread *thread) {
+        return *m_call_param_m.at(thread);
+    }
+
+    /**
+     * Completes a call. In async mode the result is queued and applied
+     * by the worker thread before its next evaluation
+     */
+    void setVoidResult(arl::eval::IEvalThread *thread);
+
+    void setIntResult(
+        arl::eval::IEvalThread  *thread,
+        int64_t                 value,
+        bool                    is_signed,
+        int32_t                 width);
+
+    /**
+     * Completes a call immediately. The caller must own the evaluation
+     * context (the worker thread in async mode)
+     */
+    void applyVoidResult(arl::eval::IEvalThread *thread);
+
+    void applyIntResult(
+        arl::eval::IEvalThread  *thread,
+        int64_t                 value,
+        bool                    is_signed,
+        int32_t                 width);
+
+    /**
+     * Moves evaluation to a worker thread, driven through AsyncEval. 
+     * Must be called before the first eval()
+     */
+    bool setAsync(bool en);
+
+    AsyncEval *getAsync() const {
+        return m_async.get();
+    }
+
+    /**
+     * Switches the actor to streaming evaluation. Rather than elaborating
+     * the root action once, the actor runs 'count' iterations of it (0 
+     * for unbounded), each in its own evaluation context. Streaming is 
+     * per iteration of the root action: a single root activity is still
+     * elaborated as a whole, so a root action whose activity contains a
+     * repeat (counted, while or forever) is rejected. Each iteration 
+     * elaborates its own component tree, so component and pool state do
+     * not carry over between iterations. Iterations run in sequence. Up
+     * to 'window' iterations are elaborated ahead, and each iteration's
+     * context is released when it completes, so memory use does not grow
+     * with the number of iterations. Must be called before the first 
+     * eval()
+     */
+    bool setStreaming(uint64_t count, uint32_t window);
+
+    /**
+     * Answers solves of the named action/struct type from a table of its
+     * solutions once that table has been learned. Intended for types 
+     * with small finite solution spaces; 'max_size' bounds the table, and
+     * 'saturate' is the number of consecutive solves without a new 
+     * solution after which the table is considered complete. A few 
+     * solves of a complete table still use the solver, adding legal 
+     * solutions missed while learning. Solves with inline
+     * constraints, and of types holding references (comp, pool or 
+     * resource handles), always use the solver
+     */
+    void addSolutionTable(
+        const std::string       &type,
+        uint32_t                max_size,
+        uint32_t                saturate) {
+        m_solver_f.addSolutionTable(type, max_size, saturate);
+    }
+
+    /**
+     * Uses a solution table shared with other actors. The actor's results
+     * then depend on what the others have learned, and are not 
+     * reproducible from its seed
+     */
+    void addSolutionTable(const std::string &type, SolutionTable *table) {
+        m_solver_f.addSolutionTable(type, table);
+    }
+
+    /**
+     * Reseeds the actor's random state
+     */
+    void reseed(const std::string &seed);
+
+    /**
+     * Saves a checkpoint. Requires that the actor was created with 
+     * journaling enabled, and that no calls are outstanding. Not 
+     * supported with a sparse memory, whose contents are not saved
+     */
+    bool save(const std::string &path);
+
+    /**
+     * Restores a checkpoint by replaying it into a fresh evaluation 
+     * context. A non-empty seed reseeds the actor once restored
+     */
+    bool restore(const std::string &path, const std::string &seed);
+
+    virtual int32_t id() const override {
+        return m_id;
+    }
+
+    const HeapStats &getHeapStats() const {
+        return *m_heap;
+    }
+
+    SolveStats getSolveStats() const {
+        return m_solver_f.getStats();
+    }
+
+    /**
+     * Returns solve statistics by action/struct type name
+     */
+    std::map<std::string, SolveStats> getSolveTypeStats() const {
+        return m_solver_f.getTypeStats();
+    }
+
+    /**
+     * Returns solve statistics by type name, in name order. Rebuilt only
+     * when the statistics have changed
+     */
+    const std::vector<std::pair<std::string, SolveStats>> &getSolveTypeStatsList() {
+        return m_solver_f.getTypeStatsList();
+    }
+
+    /**
+     * Tracks the dispatch time of outstanding target-function calls, 
+     * collecting latency statistics per function
+     */
+    void setCallTracking(bool en) {
+        m_call_track = en;
+    }
+
+    /**
+     * Sets the time (SimTime units) after which an outstanding call to 
+     * the named function is reported. "*" sets the default for all 
+     * functions, and 0 disables the timeout. Enables call tracking
+     */
+    void setCallTimeout(const std::string &func, uint64_t timeout);
+
+    /**
+     * Reports calls that exceed their timeout as fatal, rather than as
+     * errors, so that a hung call ends the simulation
+     */
+    void setCallTimeoutFatal(bool en) {
+        m_call_timeout_fatal = en;
+    }
+
+    /**
+     * Returns the smallest call timeout set, or 0 if none
+     */
+    uint64_t getMinCallTimeout() const;
+
+    /**
+     * Reports calls that have exceeded their timeout, once per call. 
+     * Returns the number of calls newly reported
+     */
+    int32_t checkCallTimeouts();
+
+    /**
+     * Returns call-latency statistics by function name
+     */
+    std::map<std::string, CallStats> getCallStats() const;
+
+    /**
+     * Returns call-latency statistics by function name, in name order.
+     * The list is rebuilt only when the statistics have changed, so it
+     * can be indexed cheaply
+     */
+    const std::vector<std::pair<std::string, CallStats>> &getCallStatsList();
+
+private:
+    struct Iteration {
+        // Declared ahead of the context, which refers to it
+        vsc::solvers::IRandStateUP                      randstate;
+        arl::eval::IEvalContextUP                       ctxt;
+    };
+    using IterationUP=std::unique_ptr<Iteration>;
+
+    struct Stream {
+        uint64_t                                        count;
+        uint32_t                                        window;
+        uint64_t                                        started;
+        std::deque<IterationUP>                         active;
+    };
+    using StreamUP=std::unique_ptr<Stream>;
+
+    /**
+     * Limit on the work done by one call to eval. A step is one 
+     * evaluation or elaboration of a root-action context
+     */
+    struct Budget {
+        bool                                            timed;
+        std::chrono::steady_clock::time_point           deadline;
+        int64_t                                         step_limit;
+        int64_t                                         steps;
+        bool                                            yielded;
+    };
+
+    int32_t evalLimited(uint64_t max_us, int64_t steps);
+
+    bool budgetExhausted();
+
+    void build(const std::string &seed);
+
+    /**
+     * Describes the streaming configuration set up before the first 
+     * eval, which a checkpoint's journal depends on
+     */
+    std::string setupSignature() const;
+
+    int32_t evalRoot();
+
+    int32_t evalStream();
+
+    void callComplete(arl::eval::IEvalThread *thread);
+
+    /**
+     * Reports a mismatch between issued and completed calls
+     */
+    void callError(const char *msg);
+
+    /**
+     * Returns the parameter pools of all outstanding calls
+     */
+    void releaseCallParams();
+
+    struct ActionType {
+        uint32_t                                        id;
+        // Indices of the fields reported in action events
+        std::vector<int32_t>                            fields;
+    };
+
+    const ActionType &getActionType(arl::dm::IDataTypeAction *action_t);
+
+    void queueActionEvent(
+        ActionEvent::Kind               kind,
+        uint64_t                        id,
+        arl::dm::IDataTypeAction        *action_t,
+        const vsc::dm::ValRef           &action_v);
+
+    /**
+     * Records the latency of a completed call
+     */
+    void callResult(arl::eval::IEvalThread *thread);
+
+    uint64_t getCallTimeout(arl::dm::IDataTypeFunction *func_t);
+
+    struct OutstandingCall {
+        arl::dm::IDataTypeFunction                      *func_t;
+        uint64_t                                        issued;
+        uint64_t                                        timeout;
+        bool                                            reported;
+    };
+
+    struct OpenAction {
+        uint64_t                                        id;
+        uint64_t                                        txn;
+    };
+
 private:
+    int32_t                                                 m_id;
+    HeapStats                                               *m_heap;
+    SolverFactoryProxy                                      m_solver_f;
+    // Parameter pool of each outstanding call. Pools of completed calls
+    // are reset and kept for reuse, so memory is bounded by the number of
+    // calls outstanding at once
+    std::unordered_map<arl::eval::IEvalThread *, ArenaUP>   m_call_param_m;
+    std::vector<ArenaUP>                                    m_call_param_free;
+    ActorCoverageUP                                         m_cov;
+    TxnRecorder                                             *m_txn;
+    bool                                                    m_act_ev_en;
+    uint64_t                                                m_n_actions;
+    // Open actions of each thread, innermost last
+    std::unordered_map<arl::eval::IEvalThread *, std::vector<OpenAction>> m_open_m;
+    std::unordered_map<arl::dm::IDataTypeAction *, ActionType>  m_act_type_m;
+    std::vector<arl::dm::IDataTypeAction *>                 m_act_types;
+    bool                                                    m_call_track;
+    bool                                                    m_call_timeout_fatal;
+    std::unordered_map<arl::eval::IEvalThread *, OutstandingCall>   m_calls;
+    std::unordered_map<arl::dm::IDataTypeFunction *, CallStats>     m_call_stats;
+    std::vector<std::pair<std::string, CallStats>>          m_call_stats_l;
+    std::atomic<bool>                                       m_call_stats_valid;
+    // Guards action events and call statistics. With setAsync, these are
+    // produced by the worker while the simulator thread reads them
+    mutable std::mutex                                      m_ev_mutex;
+    std::map<std::string, uint64_t>                         m_call_timeout_m;
+    std::unordered_map<arl::dm::IDataTypeFunction *, uint64_t>      m_call_timeout_fm;
+    // Queued action events, and the index of the first undelivered word
+    std::vector<uint64_t>                                   m_act_ev;
+    uint32_t                                                m_act_ev_rd;
+    Model                                                   *m_model;
+    arl::dm::IContext                                       *m_ctxt;
+    arl::dm::IDataTypeComponent                             *m_comp_t;
+    arl::dm::IDataTypeAction                                *m_action_t;
+    arl::eval::IEvalBackend                                 *m_backend;
+    bool                                                    m_journal_en;
+    bool                                                    m_started;
+    std::string                                             m_seed;
+    Budget                                                  m_budget;
+    bool                                                    m_budget_warned;
+    SparseMem                                               *m_mem;
+    MemMode                                                 m_mem_mode;
+    // Declared ahead of the contexts, which call into them
+    AsyncEvalUP                                             m_async;
+    SparseMemBackendUP                                      m_mem_be;
+    ActorJournalUP                                          m_journal;
+    // Backend passed to evaluation contexts: the journal or m_backend
+    arl::eval::IEvalBackend                                 *m_ctxt_backend;
     arl::eval::IEvalContextUP                               m_evalCtxt;
+    // Iterations of the root action when streamed, otherwise null
+    StreamUP                                                m_stream;
     vsc::solvers::IRandStateUP                              m_randstate;
     std::map<std::string,arl::dm::IDataTypeFunction *>      m_func_m;
     std::map<arl::dm::IDataTypeFunction *, int32_t>         m_func_id_m;
@@ -0,0 +1,133 @@
+/*
+ * ActorCoverage.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "vsc/dm/IDataTypeInt.h"
+#include "ActorCoverage.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+ActorCoverage::ActorCoverage(CovDb *db) : m_db(db), m_prior(0) {
+
+}
+
+ActorCoverage::~ActorCoverage() {
+
+}
+
+void ActorCoverage::sample(
+        arl::dm::IDataTypeAction    *action_t,
+        const vsc::dm::ValRef       &action_v) {
+    const TypeCov &cov = getTypeCov(action_t);
+
+    if (cov.bin >= 0) {
+        m_db->hit(cov.bin);
+    }
+
+    vsc::dm::ValRefStruct val_s(action_v);
+    for (std::vector<FieldCov>::const_iterator
+        it=cov.fields.begin();
+        it!=cov.fields.end(); it++) {
+        vsc::dm::ValRefInt val(val_s.getFieldRef(it->idx));
+        m_db->hit(it->bin_base + bin(*it, val.get_val_u()));
+    }
+}
+
+const ActorCoverage::TypeCov &ActorCoverage::getTypeCov(
+        arl::dm::IDataTypeAction *action_t) {
+    std::unordered_map<arl::dm::IDataTypeAction *, TypeCov>::const_iterator it;
+
+    if ((it=m_type_m.find(action_t)) != m_type_m.end()) {
+        return it->second;
+    }
+
+    // Items that don't fit in the database are left unsampled
+    TypeCov &cov = m_type_m[action_t];
+    cov.bin = m_db->addItem(action_t->name(), 1);
+
+    for (uint32_t i=0; i<action_t->getFields().size(); i++) {
+        vsc::dm::ITypeField *field = action_t->getFields().at(i).get();
+        vsc::dm::IDataTypeInt *field_t = 
+            dynamic_cast<vsc::dm::IDataTypeInt *>(field->getDataType());
+
+        if (!field_t || field_t->width() <= 0 || field_t->width() > 64) {
+            continue;
+        }
+
+        FieldCov f;
+        f.idx = i;
+        f.width = field_t->width();
+        f.is_signed = field_t->is_signed();
+        f.n_bins = (f.width <= 6)?(1U << f.width):MAX_FIELD_BINS;
+        std::string name = action_t->name() + "." + field->name();
+        f.bin_base = m_db->addItem(name, f.n_bins);
+        f.prior_base = (m_prior)?m_prior->findItem(name, f.n_bins):-1;
+        if (f.bin_base >= 0) {
+            cov.fields.push_back(f);
+        }
+    }
+
+    return cov;
+}
+
+double ActorCoverage::score(
+        const TypeCov               &cov,
+        vsc::dm::IModelField        *action_f) const {
+    double ret = 0.0;
+
+    for (std::vector<FieldCov>::const_iterator
+        it=cov.fields.begin();
+        it!=cov.fields.end(); it++) {
+        if (it->idx >= (int32_t)action_f->getFields().size()) {
+            continue;
+        }
+        vsc::dm::IModelVal *val = action_f->getFields().at(it->idx)->val();
+        uint32_t b = bin(*it, val->val_u());
+        uint64_t count = m_db->count(it->bin_base + b);
+        if (it->prior_base >= 0) {
+            count += m_prior->count(it->prior_base + b);
+        }
+        ret += 1.0/(1+count);
+    }
+
+    return ret;
+}
+
+uint32_t ActorCoverage::bin(const FieldCov &field, uint64_t val) {
+    uint64_t mask = (field.width == 64)?~0ULL:((1ULL << field.width) - 1);
+
+    val &= mask;
+    // Bias signed values so bins are ordered from most negative
+    if (field.is_signed) {
+        val ^= (1ULL << (field.width - 1));
+    }
+
+    if (field.width <= 6) {
+        return val;
+    } else {
+        return val >> (field.width - 6);
+    }
+}
+
+}
+}
+
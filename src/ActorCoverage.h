@@ -0,0 +1,111 @@
+/**
+ * ActorCoverage.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "vsc/dm/IModelField.h"
+#include "zsp/arl/dm/IDataTypeAction.h"
+#include "CovDb.h"
+
+namespace zsp {
+namespace sv {
+
+class ActorCoverage;
+using ActorCoverageUP=std::unique_ptr<ActorCoverage>;
+
+/**
+ * Samples automatic coverage when an action completes: a count per 
+ * action type, and value bins for each integer field of the action. 
+ * Fields of up to 6 bits get one bin per value; wider fields are split
+ * into 64 equal ranges. Counters live in a shared CovDb.
+ */
+class ActorCoverage {
+public:
+    static const uint32_t MAX_FIELD_BINS = 64;
+
+    ActorCoverage(CovDb *db);
+
+    virtual ~ActorCoverage();
+
+    void sample(
+        arl::dm::IDataTypeAction    *action_t,
+        const vsc::dm::ValRef       &action_v);
+
+    /**
+     * Coverage of one sampled field
+     */
+    struct FieldCov {
+        int32_t                     idx;
+        int32_t                     width;
+        bool                        is_signed;
+        uint32_t                    n_bins;
+        int64_t                     bin_base;
+        // Bins of the same item in the prior database, or -1
+        int64_t                     prior_base;
+    };
+
+    struct TypeCov {
+        int64_t                     bin;
+        std::vector<FieldCov>       fields;
+    };
+
+    /**
+     * Adds the counts of a previously-merged database when scoring. 
+     * Must be set before sampling starts
+     */
+    void setPrior(const CovDb *prior) {
+        m_prior = prior;
+    }
+
+    /**
+     * Scores the solved values of an action for coverage closure. Each 
+     * field contributes 1/(1+n), where n is the hit count of the bin its
+     * value falls in, so values in unhit bins score highest
+     */
+    double score(const TypeCov &cov, vsc::dm::IModelField *action_f) const;
+
+    /**
+     * Returns the coverage layout of an action type, creating its items
+     */
+    const TypeCov &getTypeCov(arl::dm::IDataTypeAction *action_t);
+
+    /**
+     * Returns the bin of a field value
+     */
+    static uint32_t bin(const FieldCov &field, uint64_t val);
+
+    CovDb *db() const {
+        return m_db;
+    }
+
+private:
+    CovDb                                                       *m_db;
+    const CovDb                                                 *m_prior;
+    std::unordered_map<arl::dm::IDataTypeAction *, TypeCov>     m_type_m;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,342 @@
+/*
+ * ActorJournal.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include <string.h>
+#include "Actor.h"
+#include "ActorJournal.h"
+#include "ZuspecSvDpiImp.h"
+
+
+namespace zsp {
+namespace sv {
+
+ActorJournal::ActorJournal(
+        Actor                       *actor,
+        arl::eval::IEvalBackend     *target) :
+            m_actor(actor), m_target(target), m_packed(0), m_n_packed(0),
+            m_n_calls(0), m_active_call(-1), m_replay(0) {
+
+}
+
+ActorJournal::~ActorJournal() {
+    if (m_packed) {
+        fclose(m_packed);
+    }
+}
+
+void ActorJournal::enterThreads(
+        const std::vector<arl::eval::IEvalThread *> &threads) {
+    if (!m_replay) {
+        m_target->enterThreads(threads);
+    }
+}
+
+void ActorJournal::enterThread(arl::eval::IEvalThread *thread) {
+    if (!m_replay) {
+        m_target->enterThread(thread);
+    }
+}
+
+void ActorJournal::enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    if (!m_replay) {
+        m_target->enterAction(thread, action_t, action_v);
+    }
+}
+
+void ActorJournal::leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    if (!m_replay) {
+        m_target->leaveAction(thread, action_t, action_v);
+    }
+}
+
+void ActorJournal::leaveThread(arl::eval::IEvalThread *thread) {
+    if (!m_replay) {
+        m_target->leaveThread(thread);
+    }
+}
+
+void ActorJournal::leaveThreads(
+        const std::vector<arl::eval::IEvalThread *> &threads) {
+    if (!m_replay) {
+        m_target->leaveThreads(threads);
+    }
+}
+
+void ActorJournal::callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) {
+    uint64_t call = m_n_calls++;
+    int64_t active_call = m_active_call;
+
+    // Registered first, since the call may complete before returning
+    m_outstanding[thread] = call;
+    m_active_call = call;
+
+    if (m_replay) {
+        m_replay_threads[call] = thread;
+        replayNested(call);
+    } else {
+        m_target->callFuncReq(thread, func_t, params);
+    }
+
+    m_active_call = active_call;
+}
+
+void ActorJournal::emitMessage(const std::string &msg) {
+    if (!m_replay) {
+        m_target->emitMessage(msg);
+    }
+}
+
+uint64_t ActorJournal::recordEval() {
+    JournalEvent ev = {};
+    ev.kind = JournalEvent::Eval;
+    ev.at_call = m_active_call;
+    m_events.push_back(ev);
+    return m_n_packed + m_events.size() - 1;
+}
+
+void ActorJournal::setEvalSteps(uint64_t idx, int64_t steps) {
+    // Compaction only happens between evaluations
+    m_events.at(idx - m_n_packed).value = steps;
+}
+
+void ActorJournal::recordResult(
+        arl::eval::IEvalThread  *thread,
+        JournalEvent::Kind      kind,
+        int64_t                 value,
+        bool                    is_signed,
+        int32_t                 width) {
+    std::unordered_map<arl::eval::IEvalThread *, uint64_t>::iterator it;
+
+    if ((it=m_outstanding.find(thread)) == m_outstanding.end()) {
+        return;
+    }
+
+    JournalEvent ev = {};
+    ev.kind = kind;
+    ev.is_signed = is_signed;
+    ev.width = width;
+    ev.at_call = m_active_call;
+    ev.call = it->second;
+    ev.value = value;
+    m_events.push_back(ev);
+
+    if (m_replay) {
+        m_replay_threads.erase(it->second);
+    }
+    m_outstanding.erase(it);
+}
+
+void ActorJournal::recordReseed(const std::string &seed) {
+    JournalEvent ev = {};
+    ev.kind = JournalEvent::Reseed;
+    ev.at_call = m_active_call;
+    ev.call = m_reseeds.size();
+    m_reseeds.push_back(seed);
+    m_events.push_back(ev);
+}
+
+bool ActorJournal::save(
+        const std::string       &path,
+        const std::string       &comp_t,
+        const std::string       &action_t,
+        const std::string       &setup) {
+    char tmp[1024];
+    FILE *fp = fopen(path.c_str(), "wb");
+
+    if (!fp) {
+        snprintf(tmp, sizeof(tmp), "Failed to open checkpoint %s for writing", path.c_str());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    JournalHeader hdr = {comp_t, action_t, setup, m_seed, m_reseeds, m_n_calls};
+    bool ret = JournalFile::write(fp, hdr, m_packed, m_n_packed, m_events);
+    ret &= (fclose(fp) == 0);
+
+    if (!ret) {
+        snprintf(tmp, sizeof(tmp), "Failed to write checkpoint %s", path.c_str());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    compact();
+
+    return true;
+}
+
+bool ActorJournal::load(
+        const std::string       &path,
+        const std::string       &comp_t,
+        const std::string       &action_t,
+        const std::string       &setup) {
+    char tmp[1024];
+    JournalHeader hdr;
+    FILE *fp = fopen(path.c_str(), "rb");
+
+    if (!fp) {
+        snprintf(tmp, sizeof(tmp), "Failed to open checkpoint %s", path.c_str());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    bool ok = JournalFile::read(fp, hdr, m_events);
+    fclose(fp);
+
+    if (!ok) {
+        snprintf(tmp, sizeof(tmp), "Checkpoint %s is not valid", path.c_str());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    if (hdr.comp_t != comp_t || hdr.action_t != action_t) {
+        snprintf(tmp, sizeof(tmp),
+            "Checkpoint %s is for %s / %s, not %s / %s",
+            path.c_str(), hdr.comp_t.c_str(), hdr.action_t.c_str(),
+            comp_t.c_str(), action_t.c_str());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    if (hdr.setup != setup) {
+        snprintf(tmp, sizeof(tmp),
+            "Checkpoint %s was saved by an actor set up as '%s', not '%s'",
+            path.c_str(), hdr.setup.c_str(), setup.c_str());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    m_seed = hdr.seed;
+    m_reseeds = hdr.reseeds;
+    m_n_calls = hdr.n_calls;
+
+    return true;
+}
+
+void ActorJournal::compact() {
+    uint8_t buf[JournalFile::EventSize];
+
+    if (!m_packed && !(m_packed = tmpfile())) {
+        // Events simply stay in memory
+        return;
+    }
+
+    for (std::vector<JournalEvent>::const_iterator
+        it=m_events.begin();
+        it!=m_events.end(); it++) {
+        JournalFile::pack(*it, buf);
+        fwrite(buf, 1, sizeof(buf), m_packed);
+    }
+
+    if (fflush(m_packed) != 0 || ferror(m_packed)) {
+        // Out of space. The events stay in memory, and the partial write
+        // is overwritten by the next compaction
+        clearerr(m_packed);
+        fseek(m_packed, m_n_packed*JournalFile::EventSize, SEEK_SET);
+        return;
+    }
+
+    m_n_packed += m_events.size();
+    m_events = std::vector<JournalEvent>();
+}
+
+bool ActorJournal::replay(const ActorJournal *src) {
+    char tmp[1024];
+
+    m_replay = src;
+    for (std::vector<JournalEvent>::const_iterator
+        it=src->m_events.begin();
+        it!=src->m_events.end(); it++) {
+        if (it->at_call >= 0) {
+            m_nested_m.insert({it->at_call, &(*it)});
+        }
+    }
+
+    for (std::vector<JournalEvent>::const_iterator
+        it=src->m_events.begin();
+        it!=src->m_events.end(); it++) {
+        if (it->at_call < 0) {
+            replayEvent(*it);
+        }
+    }
+
+    m_replay = 0;
+    m_nested_m.clear();
+    m_replay_threads.clear();
+
+    if (m_n_calls != src->m_n_calls || m_outstanding.size()) {
+        snprintf(tmp, sizeof(tmp),
+            "Checkpoint replay diverged (%llu calls, expected %llu)",
+            (unsigned long long)m_n_calls,
+            (unsigned long long)src->m_n_calls);
+        zuspec_error(tmp);
+        return false;
+    }
+
+    return true;
+}
+
+void ActorJournal::replayEvent(const JournalEvent &ev) {
+    std::unordered_map<uint64_t, arl::eval::IEvalThread *>::const_iterator it;
+
+    switch (ev.kind) {
+        case JournalEvent::Eval:
+            m_actor->evalSteps(ev.value);
+            break;
+        case JournalEvent::VoidResult:
+            if ((it=m_replay_threads.find(ev.call)) != m_replay_threads.end()) {
+                m_actor->applyVoidResult(it->second);
+            }
+            break;
+        case JournalEvent::IntResult:
+            if ((it=m_replay_threads.find(ev.call)) != m_replay_threads.end()) {
+                m_actor->applyIntResult(it->second, ev.value, ev.is_signed, ev.width);
+            }
+            break;
+        case JournalEvent::Reseed:
+            m_actor->reseed(m_replay->m_reseeds.at(ev.call));
+            break;
+    }
+}
+
+void ActorJournal::replayNested(int64_t call) {
+    std::pair<
+        std::multimap<int64_t, const JournalEvent *>::const_iterator,
+        std::multimap<int64_t, const JournalEvent *>::const_iterator> range =
+            m_nested_m.equal_range(call);
+
+    for (std::multimap<int64_t, const JournalEvent *>::const_iterator
+        it=range.first;
+        it!=range.second; it++) {
+        replayEvent(*it->second);
+    }
+}
+
+}
+}
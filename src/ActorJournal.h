@@ -0,0 +1,186 @@
+/**
+ * ActorJournal.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "zsp/arl/eval/impl/EvalBackendBase.h"
+#include "JournalFile.h"
+
+namespace zsp {
+namespace sv {
+
+class Actor;
+
+/**
+ * Interposes between an actor's evaluation context and its backend, and
+ * records everything that influences evaluation: eval() calls, call 
+ * results and reseeds. Since evaluation is deterministic given the seed
+ * and this journal, replaying it into a fresh context reproduces the 
+ * actor's state. The actor's configuration before its first eval 
+ * (streaming) is not replayed; it is
+ * saved as a signature that the restoring actor must match. In replay 
+ * mode, call requests are answered from the journal, and the backend is
+ * not notified of any evaluation activity.
+ * 
+ * A restore replays from the actor's seed, so the journal keeps every
+ * event. Each save compacts the events recorded so far into a private
+ * temporary file in file form, keeping only the events since the last
+ * checkpoint in memory.
+ */
+class ActorJournal;
+using ActorJournalUP=std::unique_ptr<ActorJournal>;
+class ActorJournal : public virtual arl::eval::EvalBackendBase {
+public:
+    ActorJournal(
+        Actor                       *actor,
+        arl::eval::IEvalBackend     *target);
+
+    virtual ~ActorJournal();
+
+    virtual void enterThreads(
+            const std::vector<arl::eval::IEvalThread *> &threads) override;
+
+    virtual void enterThread(arl::eval::IEvalThread *thread) override;
+
+    virtual void enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void leaveThread(arl::eval::IEvalThread *thread) override;
+
+    virtual void leaveThreads(
+            const std::vector<arl::eval::IEvalThread *> &threads) override;
+
+    virtual void callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) override;
+
+    virtual void emitMessage(const std::string &msg) override;
+
+    /**
+     * Records an eval() call, returning its event index
+     */
+    uint64_t recordEval();
+
+    /**
+     * Records the number of steps taken by a budgeted eval that yielded
+     */
+    void setEvalSteps(uint64_t idx, int64_t steps);
+
+    void recordResult(
+        arl::eval::IEvalThread  *thread,
+        JournalEvent::Kind      kind,
+        int64_t                 value=0,
+        bool                    is_signed=false,
+        int32_t                 width=0);
+
+    void recordReseed(const std::string &seed);
+
+    uint32_t numOutstanding() const {
+        return m_outstanding.size();
+    }
+
+    /**
+     * True while call requests are answered from a replayed journal
+     */
+    bool replaying() const {
+        return m_replay != 0;
+    }
+
+    /**
+     * Saves the journal, then compacts it. 'setup' describes the actor's
+     * configuration before its first eval
+     */
+    bool save(
+        const std::string       &path,
+        const std::string       &comp_t,
+        const std::string       &action_t,
+        const std::string       &setup);
+
+    /**
+     * Reads a journal saved by save(). Returns false if the file is 
+     * unreadable, or was saved for different types or a different setup
+     */
+    bool load(
+        const std::string       &path,
+        const std::string       &comp_t,
+        const std::string       &action_t,
+        const std::string       &setup);
+
+    /**
+     * Replays a journal read by load() into this (fresh) journal's actor
+     */
+    bool replay(const ActorJournal *src);
+
+    const std::string &seed() const {
+        return m_seed;
+    }
+
+    void setSeed(const std::string &seed) {
+        m_seed = seed;
+    }
+
+private:
+    /**
+     * Moves the events in memory to the compacted file
+     */
+    void compact();
+
+    void replayEvent(const JournalEvent &ev);
+
+    void replayNested(int64_t call);
+
+private:
+    Actor                                                   *m_actor;
+    arl::eval::IEvalBackend                                 *m_target;
+    std::string                                             m_seed;
+    std::vector<std::string>                                m_reseeds;
+    // Events since the last compaction. Indices of events are counted
+    // from the start of the journal, including compacted events
+    std::vector<JournalEvent>                               m_events;
+    FILE                                                    *m_packed;
+    uint64_t                                                m_n_packed;
+    uint64_t                                                m_n_calls;
+    int64_t                                                 m_active_call;
+    std::unordered_map<arl::eval::IEvalThread *, uint64_t>  m_outstanding;
+
+    // Replay state
+    const ActorJournal                                      *m_replay;
+    std::multimap<int64_t, const JournalEvent *>            m_nested_m;
+    std::unordered_map<uint64_t, arl::eval::IEvalThread *>  m_replay_threads;
+
+};
+
+}
+}
+
+
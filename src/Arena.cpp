@@ -0,0 +1,113 @@
+/*
+ * Arena.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdlib.h>
+#include "Arena.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+Arena::Arena(size_t block_sz) : m_block_sz(block_sz), m_block(0), 
+    m_off(0), m_used_prev(0) {
+
+}
+
+Arena::~Arena() {
+    reset();
+    for (std::vector<Block>::const_iterator
+        it=m_blocks.begin();
+        it!=m_blocks.end(); it++) {
+        free(it->data);
+    }
+}
+
+void *Arena::alloc(size_t sz, size_t align) {
+    if (m_block < m_blocks.size()) {
+        uintptr_t base = reinterpret_cast<uintptr_t>(m_blocks[m_block].data);
+        size_t off = ((base + m_off + align - 1) & ~(uintptr_t)(align - 1)) - base;
+        if (off + sz <= m_blocks[m_block].size) {
+            m_off = off + sz;
+            return m_blocks[m_block].data + off;
+        }
+    }
+    return allocSlow(sz, align);
+}
+
+void *Arena::allocSlow(size_t sz, size_t align) {
+    // Move to the next retained block that fits, allocating one if needed.
+    // Oversize requests get a dedicated block
+    if (m_block < m_blocks.size()) {
+        m_used_prev += m_off;
+        m_block++;
+    }
+    m_off = 0;
+
+    while (m_block < m_blocks.size() && m_blocks[m_block].size < sz + align) {
+        m_block++;
+    }
+
+    if (m_block == m_blocks.size()) {
+        size_t size = (sz + align > m_block_sz)?(sz + align):m_block_sz;
+        Block b = {reinterpret_cast<char *>(malloc(size)), size};
+        if (!b.data) {
+            throw std::bad_alloc();
+        }
+        m_blocks.push_back(b);
+    }
+
+    // malloc'd blocks are aligned to max_align_t
+    size_t off = (align > alignof(max_align_t))?(align - 1):0;
+    char *p = reinterpret_cast<char *>(
+        (reinterpret_cast<uintptr_t>(m_blocks[m_block].data) + off) & ~(uintptr_t)(align - 1));
+    m_off = (p - m_blocks[m_block].data) + sz;
+    return p;
+}
+
+void Arena::reset() {
+    for (std::vector<Finalizer>::const_reverse_iterator
+        it=m_finalizers.rbegin();
+        it!=m_finalizers.rend(); it++) {
+        it->func(it->obj, it->n);
+    }
+    m_finalizers.clear();
+    m_block = 0;
+    m_off = 0;
+    m_used_prev = 0;
+}
+
+size_t Arena::used() const {
+    return m_used_prev + m_off;
+}
+
+size_t Arena::capacity() const {
+    size_t ret = 0;
+    for (std::vector<Block>::const_iterator
+        it=m_blocks.begin();
+        it!=m_blocks.end(); it++) {
+        ret += it->size;
+    }
+    return ret;
+}
+
+}
+}
+
@@ -0,0 +1,129 @@
+/**
+ * Arena.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace zsp {
+namespace sv {
+
+
+class Arena;
+using ArenaUP=std::unique_ptr<Arena>;
+
+/**
+ * Region allocator for the temporaries of an outstanding call. Objects are
+ * bump-allocated from a list of blocks and released together by reset().
+ * Blocks are kept across resets, so a steady-state call does not touch 
+ * the heap. Destructors of non-trivial objects are run by reset() in 
+ * reverse order of construction.
+ */
+class Arena {
+public:
+    Arena(size_t block_sz=64*1024);
+
+    virtual ~Arena();
+
+    void *alloc(size_t sz, size_t align=alignof(max_align_t));
+
+    template <class T, class... Args> T *mk(Args&&... args) {
+        T *ret = new (alloc(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            addFinalizer(&Arena::destroy<T>, ret, 1);
+        }
+        return ret;
+    }
+
+    /**
+     * Allocates an array of 'n' elements copied from 'src'
+     */
+    template <class T> T *mkArray(size_t n, const T *src) {
+        T *ret = reinterpret_cast<T *>(alloc(sizeof(T)*n, alignof(T)));
+        for (size_t i=0; i<n; i++) {
+            new (&ret[i]) T(src[i]);
+        }
+        if (n && !std::is_trivially_destructible<T>::value) {
+            addFinalizer(&Arena::destroy<T>, ret, n);
+        }
+        return ret;
+    }
+
+    /**
+     * Destroys all objects and rewinds to the first block
+     */
+    void reset();
+
+    /**
+     * Bytes handed out since the last reset
+     */
+    size_t used() const;
+
+    /**
+     * Bytes held in blocks
+     */
+    size_t capacity() const;
+
+private:
+    typedef void (*FinalizerF)(void *, size_t);
+
+    struct Block {
+        char                    *data;
+        size_t                  size;
+    };
+
+    struct Finalizer {
+        FinalizerF              func;
+        void                    *obj;
+        size_t                  n;
+    };
+
+    template <class T> static void destroy(void *obj, size_t n) {
+        T *objs = reinterpret_cast<T *>(obj);
+        for (size_t i=n; i>0; i--) {
+            objs[i-1].~T();
+        }
+    }
+
+    void addFinalizer(FinalizerF func, void *obj, size_t n) {
+        m_finalizers.push_back({func, obj, n});
+    }
+
+    void *allocSlow(size_t sz, size_t align);
+
+private:
+    size_t                          m_block_sz;
+    std::vector<Block>              m_blocks;
+    size_t                          m_block;
+    size_t                          m_off;
+    size_t                          m_used_prev;
+    std::vector<Finalizer>          m_finalizers;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,188 @@
+/*
+ * AsyncEval.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "Actor.h"
+#include "AsyncEval.h"
+#include "ZuspecSvDpiImp.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+AsyncEval::AsyncEval(
+        Actor                       *actor,
+        arl::eval::IEvalBackend     *target) :
+            m_actor(actor), m_target(target), m_status(0),
+            m_eval_req(false), m_stop(false), m_n_reqs(0) {
+    m_thread = std::thread(&AsyncEval::run, this);
+}
+
+AsyncEval::~AsyncEval() {
+    stop();
+}
+
+void AsyncEval::request() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_status.store(-1, std::memory_order_release);
+    m_eval_req = true;
+    m_cond.notify_one();
+}
+
+int32_t AsyncEval::dispatch() {
+    if (busy()) {
+        return -1;
+    }
+
+    // Dispatching a call may queue further requests (eg an error from 
+    // the actor), which would reallocate the list being dispatched. The
+    // pending requests are moved aside first, and dispatch repeats until
+    // none are left
+    while (m_n_reqs) {
+        uint32_t n = m_n_reqs;
+        m_reqs.swap(m_reqs_d);
+        m_n_reqs = 0;
+        for (uint32_t i=0; i<n; i++) {
+            Request &req = m_reqs_d.at(i);
+            if (req.func_t) {
+                m_target->callFuncReq(req.thread, req.func_t, req.params);
+            } else if (req.is_error) {
+                zuspec_error(req.msg.c_str());
+            } else {
+                m_target->emitMessage(req.msg);
+            }
+            req.params.clear();
+            req.msg.clear();
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_results.size();
+}
+
+void AsyncEval::postVoidResult(arl::eval::IEvalThread *thread) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_results.push_back({thread, true, false, 0, 0});
+}
+
+void AsyncEval::postIntResult(
+        arl::eval::IEvalThread  *thread,
+        int64_t                 value,
+        bool                    is_signed,
+        int32_t                 width) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_results.push_back({thread, false, is_signed, width, value});
+}
+
+void AsyncEval::postError(const std::string &msg) {
+    Request &req = nextRequest();
+    req.thread = 0;
+    req.func_t = 0;
+    req.msg = msg;
+    req.is_error = true;
+}
+
+void AsyncEval::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cond.notify_one();
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void AsyncEval::callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) {
+    Request &req = nextRequest();
+    req.thread = thread;
+    req.func_t = func_t;
+    req.params.assign(params.begin(), params.end());
+    req.is_error = false;
+}
+
+void AsyncEval::enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_target->enterAction(thread, action_t, action_v);
+}
+
+void AsyncEval::leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_target->leaveAction(thread, action_t, action_v);
+}
+
+void AsyncEval::emitMessage(const std::string &msg) {
+    Request &req = nextRequest();
+    req.thread = 0;
+    req.func_t = 0;
+    req.msg = msg;
+    req.is_error = false;
+}
+
+AsyncEval::Request &AsyncEval::nextRequest() {
+    if (m_n_reqs == m_reqs.size()) {
+        m_reqs.push_back(Request());
+    }
+    return m_reqs.at(m_n_reqs++);
+}
+
+void AsyncEval::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_cond.wait(lock, [this]() { return m_eval_req || m_stop; });
+
+        if (m_stop) {
+            break;
+        }
+
+        m_eval_req = false;
+        m_results_w.swap(m_results);
+        lock.unlock();
+
+        for (std::vector<Result>::const_iterator
+            it=m_results_w.begin();
+            it!=m_results_w.end(); it++) {
+            if (it->is_void) {
+                m_actor->applyVoidResult(it->thread);
+            } else {
+                m_actor->applyIntResult(
+                    it->thread, it->value, it->is_signed, it->width);
+            }
+        }
+        m_results_w.clear();
+
+        int32_t ret = m_actor->eval();
+
+        lock.lock();
+        m_status.store(ret, std::memory_order_release);
+    }
+}
+
+}
+}
+
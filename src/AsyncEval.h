@@ -0,0 +1,168 @@
+/**
+ * AsyncEval.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "zsp/arl/eval/impl/EvalBackendBase.h"
+
+namespace zsp {
+namespace sv {
+
+class Actor;
+
+class AsyncEval;
+using AsyncEvalUP=std::unique_ptr<AsyncEval>;
+
+/**
+ * Runs an actor's evaluation on a worker thread. The simulator requests
+ * an evaluation, polls for its completion, then dispatches the calls and
+ * messages the evaluation produced. Call results posted by the simulator
+ * are queued and applied by the worker before its next evaluation. 
+ * 
+ * The evaluation context is only touched by one side at a time: the 
+ * worker between request() and the point where poll() reports a status,
+ * and the simulator thread otherwise.
+ */
+class AsyncEval : public virtual arl::eval::EvalBackendBase {
+public:
+    AsyncEval(
+        Actor                       *actor,
+        arl::eval::IEvalBackend     *target);
+
+    virtual ~AsyncEval();
+
+    /**
+     * Starts an evaluation on the worker thread
+     */
+    void request();
+
+    /**
+     * Returns -1 while an evaluation is running, and the result of the
+     * last evaluation otherwise. Safe to call from any thread
+     */
+    int32_t poll() const {
+        return m_status.load(std::memory_order_acquire);
+    }
+
+    bool busy() const {
+        return poll() < 0;
+    }
+
+    /**
+     * Issues the calls and messages produced by the last evaluation to 
+     * the target backend. Returns the number of call results waiting to
+     * be applied, or -1 if an evaluation is running
+     */
+    int32_t dispatch();
+
+    void postVoidResult(arl::eval::IEvalThread *thread);
+
+    void postIntResult(
+        arl::eval::IEvalThread  *thread,
+        int64_t                 value,
+        bool                    is_signed,
+        int32_t                 width);
+
+    /**
+     * Queues an error detected on the worker thread, to be reported by 
+     * dispatch() on the simulator thread
+     */
+    void postError(const std::string &msg);
+
+    /**
+     * Stops the worker thread, waiting for any running evaluation
+     */
+    void stop();
+
+    virtual void callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) override;
+
+    /**
+     * Action start/end notifications are forwarded directly from the
+     * worker thread, since the action value is only valid during the
+     * notification. The target must not call into the simulator. The 
+     * actor locks the state (action events, call statistics) that the 
+     * simulator thread reads while the worker runs
+     */
+    virtual void enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void emitMessage(const std::string &msg) override;
+
+private:
+    struct Request {
+        arl::eval::IEvalThread              *thread;
+        arl::dm::IDataTypeFunction          *func_t;
+        std::vector<vsc::dm::ValRef>        params;
+        // Set for messages and errors, which have no function
+        std::string                         msg;
+        bool                                is_error;
+    };
+
+    struct Result {
+        arl::eval::IEvalThread              *thread;
+        bool                                is_void;
+        bool                                is_signed;
+        int32_t                             width;
+        int64_t                             value;
+    };
+
+    Request &nextRequest();
+
+    void run();
+
+private:
+    Actor                                   *m_actor;
+    arl::eval::IEvalBackend                 *m_target;
+    std::atomic<int32_t>                    m_status;
+    std::mutex                              m_mutex;
+    std::condition_variable                 m_cond;
+    bool                                    m_eval_req;
+    bool                                    m_stop;
+    // Requests are reused across evaluations to keep their storage. 
+    // m_reqs_d holds those being dispatched
+    std::vector<Request>                    m_reqs;
+    std::vector<Request>                    m_reqs_d;
+    uint32_t                                m_n_reqs;
+    std::vector<Result>                     m_results;
+    std::vector<Result>                     m_results_w;
+    std::thread                             m_thread;
+
+};
+
+}
+}
+
+
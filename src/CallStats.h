@@ -0,0 +1,107 @@
+/**
+ * CallStats.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+namespace zsp {
+namespace sv {
+
+/**
+ * Latency statistics for calls to one function, in simulation time 
+ * (SimTime) from dispatch to result. Latencies are kept in a log-linear
+ * histogram: four buckets per power of two, so percentiles are accurate
+ * to within 25%.
+ */
+struct CallStats {
+    static const uint32_t SUB_BITS = 2;
+    static const uint32_t N_BUCKETS = (64 << SUB_BITS);
+
+    CallStats() : count(0), timeouts(0), total(0), max(0) {
+        memset(buckets, 0, sizeof(buckets));
+    }
+
+    void record(uint64_t latency) {
+        count++;
+        total += latency;
+        max = (latency > max)?latency:max;
+        buckets[bucket(latency)]++;
+    }
+
+    void add(const CallStats &o) {
+        count += o.count;
+        timeouts += o.timeouts;
+        total += o.total;
+        max = (o.max > max)?o.max:max;
+        for (uint32_t i=0; i<N_BUCKETS; i++) {
+            buckets[i] += o.buckets[i];
+        }
+    }
+
+    /**
+     * Returns an upper bound on the p'th percentile (0..100) latency
+     */
+    uint64_t percentile(double p) const {
+        uint64_t target = (p/100.0)*count + 0.5;
+        uint64_t n = 0;
+
+        target = (target < 1)?1:target;
+        for (uint32_t i=0; i<N_BUCKETS; i++) {
+            n += buckets[i];
+            if (n >= target) {
+                uint64_t ret = bucketMax(i);
+                return (ret < max)?ret:max;
+            }
+        }
+        return max;
+    }
+
+    static uint32_t bucket(uint64_t v) {
+        if (v < (1U << SUB_BITS)) {
+            return v;
+        }
+        uint32_t msb = 63 - __builtin_clzll(v);
+        uint32_t sub = (v >> (msb - SUB_BITS)) & ((1U << SUB_BITS) - 1);
+        return ((msb - SUB_BITS + 1) << SUB_BITS) + sub;
+    }
+
+    static uint64_t bucketMax(uint32_t b) {
+        if (b < (1U << SUB_BITS)) {
+            return b;
+        }
+        uint32_t shift = (b >> SUB_BITS) - 1;
+        uint64_t sub = b & ((1U << SUB_BITS) - 1);
+        uint64_t lower = ((1ULL << SUB_BITS) + sub) << shift;
+        return lower + ((1ULL << shift) - 1);
+    }
+
+    uint64_t                    count;
+    // Calls reported as exceeding their timeout
+    uint64_t                    timeouts;
+    uint64_t                    total;
+    uint64_t                    max;
+    uint64_t                    buckets[N_BUCKETS];
+};
+
+}
+}
+
+
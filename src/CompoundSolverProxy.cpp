@@ -0,0 +1,183 @@
+/*
+ * CompoundSolverProxy.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <chrono>
+#include "vsc/dm/IModelField.h"
+#include "CompoundSolverProxy.h"
+#include "SolverFactoryProxy.h"
+#include "StatsShm.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+CompoundSolverProxy::CompoundSolverProxy(
+    SolverFactoryProxy              *factory,
+    vsc::solvers::ICompoundSolver   *target) : 
+        m_factory(factory), m_target(target) {
+
+}
+
+CompoundSolverProxy::~CompoundSolverProxy() {
+
+}
+
+// Collects the random leaf fields. Returns false if one is too wide
+static bool collect_rand(
+        vsc::dm::IModelField                    *field,
+        std::vector<vsc::dm::IModelField *>     &vars) {
+    if (field->getFields().size()) {
+        for (std::vector<vsc::dm::IModelFieldUP>::const_iterator
+            it=field->getFields().begin();
+            it!=field->getFields().end(); it++) {
+            if (!collect_rand(it->get(), vars)) {
+                return false;
+            }
+        }
+    } else if (field->isFlagSet(vsc::dm::ModelFieldFlag::DeclRand)
+        || field->isFlagSet(vsc::dm::ModelFieldFlag::UsedRand)) {
+        if (!field->val() || field->val()->bits() > 64) {
+            return false;
+        }
+        vars.push_back(field);
+    }
+    return true;
+}
+
+static uint64_t count_vars(vsc::dm::IModelField *field) {
+    if (!field->getFields().size()) {
+        return 1;
+    }
+    uint64_t ret = 0;
+    for (std::vector<vsc::dm::IModelFieldUP>::const_iterator
+        it=field->getFields().begin();
+        it!=field->getFields().end(); it++) {
+        ret += count_vars(it->get());
+    }
+    return ret;
+}
+
+bool CompoundSolverProxy::solve(
+        vsc::solvers::IRandState                        *randstate,
+        const std::vector<vsc::dm::IModelField *>       &fields,
+        const std::vector<vsc::dm::IModelConstraint *>  &constraints,
+        vsc::solvers::SolveFlags                        flags) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    vsc::dm::IDataType *type = (fields.size())?fields.at(0)->getDataType():0;
+    // Tables are keyed only on the fields' values. Inline constraints 
+    // (with-clauses, activity and sibling constraints) change the solution
+    // space without changing that key, so such solves bypass the table. 
+    // The table itself declines fields that hold references
+    SolutionTable *table = (constraints.size())?0:m_factory->getSolutionTable(type);
+    bool hit = (table && table->sample(randstate, fields, static_cast<int32_t>(flags)));
+    bool ret = true;
+
+    ActorCoverage *cov = m_factory->getCoverageBias();
+    arl::dm::IDataTypeAction *action_t = (cov)?
+        dynamic_cast<arl::dm::IDataTypeAction *>(type):0;
+
+    if (!hit) {
+        if (action_t && fields.size() == 1) {
+            ret = solveBiased(randstate, fields, constraints, flags, 
+                cov->getTypeCov(action_t));
+        } else {
+            ret = m_target->solve(randstate, fields, constraints, flags);
+        }
+        if (table && ret) {
+            table->record(fields, static_cast<int32_t>(flags));
+        }
+    }
+
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    // Solves are attributed to the type of the first root field, which
+    // is the action or struct being randomized
+    uint64_t vars = 0;
+    for (std::vector<vsc::dm::IModelField *>::const_iterator
+        it=fields.begin();
+        it!=fields.end(); it++) {
+        vars += count_vars(*it);
+    }
+    m_factory->recordSolve(type, ns, vars, ret, hit);
+
+    ShmStatsBlock *shm = StatsShm::block();
+    if (shm) {
+        shm->solves.fetch_add(1, std::memory_order_relaxed);
+        shm->solve_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    return ret;
+}
+
+bool CompoundSolverProxy::solveBiased(
+        vsc::solvers::IRandState                        *randstate,
+        const std::vector<vsc::dm::IModelField *>       &fields,
+        const std::vector<vsc::dm::IModelConstraint *>  &constraints,
+        vsc::solvers::SolveFlags                        flags,
+        const ActorCoverage::TypeCov                    &cov) {
+    ActorCoverage *bias = m_factory->getCoverageBias();
+    uint32_t k = m_factory->getCoverageBiasK();
+    vsc::dm::IModelField *action_f = fields.at(0);
+    double best = -1.0, max = cov.fields.size();
+
+    m_vars.clear();
+    if (!cov.fields.size() || !collect_rand(action_f, m_vars)) {
+        return m_target->solve(randstate, fields, constraints, flags);
+    }
+
+    for (uint32_t i=0; i<k; i++) {
+        if (!m_target->solve(randstate, fields, constraints, flags)) {
+            // An unsatisfiable problem won't improve on re-solving
+            if (best < 0) {
+                return false;
+            }
+            break;
+        }
+
+        double score = bias->score(cov, action_f);
+        if (score > best) {
+            best = score;
+            m_best.clear();
+            for (std::vector<vsc::dm::IModelField *>::const_iterator
+                it=m_vars.begin();
+                it!=m_vars.end(); it++) {
+                m_best.push_back((*it)->val()->val_u());
+            }
+            // Every field in an unhit bin; no solution can do better
+            if (score >= max) {
+                break;
+            }
+        }
+    }
+
+    for (uint32_t i=0; i<m_vars.size(); i++) {
+        vsc::dm::IModelVal *val = m_vars.at(i)->val();
+        val->set_val_u(m_best.at(i), val->bits());
+    }
+
+    return true;
+}
+
+}
+}
+
@@ -0,0 +1,67 @@
+/**
+ * CompoundSolverProxy.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <vector>
+#include "vsc/solvers/ICompoundSolver.h"
+#include "ActorCoverage.h"
+
+namespace zsp {
+namespace sv {
+
+class SolverFactoryProxy;
+
+class CompoundSolverProxy : public virtual vsc::solvers::ICompoundSolver {
+public:
+    CompoundSolverProxy(
+        SolverFactoryProxy              *factory,
+        vsc::solvers::ICompoundSolver   *target);
+
+    virtual ~CompoundSolverProxy();
+
+    virtual bool solve(
+        vsc::solvers::IRandState                        *randstate,
+        const std::vector<vsc::dm::IModelField *>       &fields,
+        const std::vector<vsc::dm::IModelConstraint *>  &constraints,
+        vsc::solvers::SolveFlags                        flags) override;
+
+private:
+    /**
+     * Solves 'k' times, keeping the solution that best advances coverage
+     */
+    bool solveBiased(
+        vsc::solvers::IRandState                        *randstate,
+        const std::vector<vsc::dm::IModelField *>       &fields,
+        const std::vector<vsc::dm::IModelConstraint *>  &constraints,
+        vsc::solvers::SolveFlags                        flags,
+        const ActorCoverage::TypeCov                    &cov);
+
+private:
+    SolverFactoryProxy                  *m_factory;
+    std::vector<vsc::dm::IModelField *> m_vars;
+    std::vector<uint64_t>               m_best;
+    vsc::solvers::ICompoundSolverUP     m_target;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,235 @@
+/*
+ * CovDb.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "CovDb.h"
+
+
+namespace zsp {
+namespace sv {
+
+static const char COVDB_MAGIC[8] = {'Z','S','P','C','O','V','\0','\0'};
+
+static uint64_t align8(uint64_t v) {
+    return (v + 7) & ~7ULL;
+}
+
+CovDb::CovDb(
+    const std::string   &path,
+    int                 fd,
+    void                *base,
+    uint64_t            size) : m_path(path), m_fd(fd), m_base(base), 
+        m_size(size) {
+    attach();
+}
+
+CovDb::~CovDb() {
+    uint64_t used = m_hdr->bins_off + sizeof(uint64_t)*m_hdr->n_bins;
+
+    if (m_fd != -1) {
+        // The bin capacity shrinks with the file, so that a database 
+        // reopened for writing doesn't add bins past its end
+        if (used < m_size) {
+            m_hdr->max_bins = m_hdr->n_bins;
+        }
+        msync(m_base, m_size, MS_SYNC);
+    }
+    munmap(m_base, m_size);
+    if (m_fd != -1) {
+        // Drop the unused capacity at the end of the bin region
+        if (used < m_size && ftruncate(m_fd, used) == -1) {
+            // The file remains valid at its full size
+        }
+        ::close(m_fd);
+    }
+}
+
+CovDb *CovDb::create(
+        const std::string       &path,
+        uint32_t                max_items,
+        uint64_t                max_bins,
+        uint64_t                max_names) {
+    uint64_t items_off = align8(sizeof(CovDbHeader));
+    uint64_t names_off = align8(items_off + sizeof(CovDbItem)*max_items);
+    uint64_t bins_off = align8(names_off + max_names);
+    uint64_t size = bins_off + sizeof(uint64_t)*max_bins;
+
+    int fd = ::open(path.c_str(), O_CREAT|O_TRUNC|O_RDWR, 0644);
+    if (fd == -1) {
+        return 0;
+    }
+
+    // The file is sparse until bins are touched
+    if (ftruncate(fd, size) == -1) {
+        ::close(fd);
+        return 0;
+    }
+
+    void *p = mmap(0, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        ::close(fd);
+        return 0;
+    }
+
+    CovDbHeader *hdr = reinterpret_cast<CovDbHeader *>(p);
+    memcpy(hdr->magic, COVDB_MAGIC, sizeof(COVDB_MAGIC));
+    hdr->version = CovDbHeader::VERSION;
+    hdr->max_items = max_items;
+    hdr->max_bins = max_bins;
+    hdr->max_names = max_names;
+    hdr->runs = 1;
+    hdr->items_off = items_off;
+    hdr->names_off = names_off;
+    hdr->bins_off = bins_off;
+
+    return new CovDb(path, fd, p, size);
+}
+
+CovDb *CovDb::open(
+        const std::string       &path,
+        bool                    writable,
+        std::string             &err) {
+    struct stat st;
+    int fd = ::open(path.c_str(), (writable)?O_RDWR:O_RDONLY);
+
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        err = "cannot open " + path + ": " + strerror(errno);
+        if (fd != -1) {
+            ::close(fd);
+        }
+        return 0;
+    }
+
+    uint64_t size = st.st_size;
+    void *p = (size >= sizeof(CovDbHeader))?mmap(0, size, 
+        (writable)?(PROT_READ|PROT_WRITE):PROT_READ, MAP_SHARED, fd, 0):MAP_FAILED;
+
+    if (p == MAP_FAILED) {
+        err = path + " is not a coverage database";
+        ::close(fd);
+        return 0;
+    }
+
+    const CovDbHeader *hdr = reinterpret_cast<const CovDbHeader *>(p);
+    if (memcmp(hdr->magic, COVDB_MAGIC, sizeof(COVDB_MAGIC))
+        || hdr->version != CovDbHeader::VERSION
+        || hdr->items_off + sizeof(CovDbItem)*hdr->n_items > size
+        || hdr->names_off + hdr->names_size > size
+        || hdr->bins_off + sizeof(uint64_t)*hdr->n_bins > size) {
+        err = path + " is not a valid coverage database";
+        munmap(p, size);
+        ::close(fd);
+        return 0;
+    }
+
+    if (writable) {
+        // Capacity is bounded by the mapping, in case the file was 
+        // trimmed without updating the header
+        CovDbHeader *w_hdr = reinterpret_cast<CovDbHeader *>(p);
+        uint64_t max_bins = (size - w_hdr->bins_off) / sizeof(uint64_t);
+        if (w_hdr->max_bins > max_bins) {
+            w_hdr->max_bins = max_bins;
+        }
+    } else {
+        ::close(fd);
+        fd = -1;
+    }
+
+    return new CovDb(path, fd, p, size);
+}
+
+void CovDb::attach() {
+    char *base = reinterpret_cast<char *>(m_base);
+    m_hdr = reinterpret_cast<CovDbHeader *>(base);
+    m_items = reinterpret_cast<CovDbItem *>(base + m_hdr->items_off);
+    m_names = base + m_hdr->names_off;
+    m_bins = reinterpret_cast<std::atomic<uint64_t> *>(base + m_hdr->bins_off);
+
+    for (uint32_t i=0; i<m_hdr->n_items; i++) {
+        m_item_m.insert({itemName(i), i});
+    }
+}
+
+int64_t CovDb::addItem(const std::string &name, uint32_t n_bins) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<std::string, uint32_t>::const_iterator it;
+
+    if ((it=m_item_m.find(name)) != m_item_m.end()) {
+        const CovDbItem &item = m_items[it->second];
+        return (item.n_bins == n_bins)?(int64_t)item.bin_base:-1;
+    }
+
+    if (m_fd == -1
+        || m_hdr->n_items >= m_hdr->max_items
+        || m_hdr->n_bins + n_bins > m_hdr->max_bins
+        || m_hdr->names_size + name.size() > m_hdr->max_names) {
+        return -1;
+    }
+
+    CovDbItem &item = m_items[m_hdr->n_items];
+    item.name_off = m_hdr->names_size;
+    item.name_len = name.size();
+    item.n_bins = n_bins;
+    item.bin_base = m_hdr->n_bins;
+    memcpy(m_names + item.name_off, name.c_str(), name.size());
+
+    m_hdr->names_size += name.size();
+    m_hdr->n_bins += n_bins;
+    m_item_m.insert({name, m_hdr->n_items});
+
+    m_hdr->n_items++;
+
+    return item.bin_base;
+}
+
+int64_t CovDb::findItem(const std::string &name, uint32_t n_bins) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_map<std::string, uint32_t>::const_iterator it;
+
+    if ((it=m_item_m.find(name)) != m_item_m.end()
+        && m_items[it->second].n_bins == n_bins) {
+        return m_items[it->second].bin_base;
+    }
+    return -1;
+}
+
+uint32_t CovDb::numHit(uint32_t idx) const {
+    const CovDbItem &item = m_items[idx];
+    uint32_t ret = 0;
+    for (uint32_t i=0; i<item.n_bins; i++) {
+        if (count(item.bin_base+i)) {
+            ret++;
+        }
+    }
+    return ret;
+}
+
+void CovDb::sync() {
+    msync(m_base, m_size, MS_SYNC);
+}
+
+}
+}
+
@@ -0,0 +1,175 @@
+/**
+ * CovDb.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+namespace zsp {
+namespace sv {
+
+/**
+ * On-disk layout of a coverage database. Offsets are from the start of
+ * the file. A database written during simulation has fixed-capacity 
+ * item and name regions; merged databases are sized to fit. Counters 
+ * are 64-bit and updated with relaxed atomics while mapped.
+ */
+struct CovDbHeader {
+    static const uint32_t VERSION = 1;
+
+    char                        magic[8];   // "ZSPCOV\0\0"
+    uint32_t                    version;
+    uint32_t                    n_items;
+    uint32_t                    max_items;
+    uint32_t                    pad;
+    uint64_t                    n_bins;
+    uint64_t                    max_bins;
+    uint64_t                    names_size;
+    uint64_t                    max_names;
+    // Number of simulation runs merged into this database
+    uint64_t                    runs;
+    uint64_t                    items_off;
+    uint64_t                    names_off;
+    uint64_t                    bins_off;
+};
+
+struct CovDbItem {
+    uint64_t                    name_off;
+    uint32_t                    name_len;
+    uint32_t                    n_bins;
+    uint64_t                    bin_base;
+};
+
+class CovDb;
+using CovDbUP=std::unique_ptr<CovDb>;
+
+/**
+ * A memory-mapped coverage database. Items (a named set of bins) are 
+ * added on first use; counters are incremented in place, so the file 
+ * on disk is current without an explicit save. Shared by all actors.
+ */
+class CovDb {
+public:
+
+    virtual ~CovDb();
+
+    /**
+     * Creates (truncating) a database file for writing
+     */
+    static CovDb *create(
+        const std::string       &path,
+        uint32_t                max_items=16384,
+        uint64_t                max_bins=(1ULL << 20),
+        uint64_t                max_names=(1ULL << 20));
+
+    /**
+     * Maps an existing database. Returns null, with 'err' set, on error.
+     * A database reopened for writing can only add items while bins 
+     * remain within the file, which is trimmed when the database is 
+     * closed
+     */
+    static CovDb *open(
+        const std::string       &path,
+        bool                    writable,
+        std::string             &err);
+
+    /**
+     * Returns the base index of the named item's bins, adding it if 
+     * needed. Returns -1 if the database is full or the item exists 
+     * with a different number of bins
+     */
+    int64_t addItem(const std::string &name, uint32_t n_bins);
+
+    /**
+     * Returns the base index of the named item's bins, or -1 if it is 
+     * not present with 'n_bins' bins
+     */
+    int64_t findItem(const std::string &name, uint32_t n_bins) const;
+
+    void hit(uint64_t bin) {
+        m_bins[bin].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void add(uint64_t bin, uint64_t n) {
+        m_bins[bin].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    const CovDbHeader *header() const {
+        return m_hdr;
+    }
+
+    void setRuns(uint64_t runs) {
+        m_hdr->runs = runs;
+    }
+
+    const CovDbItem &item(uint32_t idx) const {
+        return m_items[idx];
+    }
+
+    std::string itemName(uint32_t idx) const {
+        return std::string(m_names + m_items[idx].name_off, m_items[idx].name_len);
+    }
+
+    uint64_t count(uint64_t bin) const {
+        return m_bins[bin].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Number of bins of an item with a non-zero count
+     */
+    uint32_t numHit(uint32_t idx) const;
+
+    /**
+     * Flushes counters to disk. The unused tail of the bin region is
+     * trimmed from the file when the database is closed
+     */
+    void sync();
+
+    const std::string &path() const {
+        return m_path;
+    }
+
+private:
+    CovDb(const std::string &path, int fd, void *base, uint64_t size);
+
+    void attach();
+
+private:
+    std::string                                 m_path;
+    int                                         m_fd;
+    void                                        *m_base;
+    uint64_t                                    m_size;
+    CovDbHeader                                 *m_hdr;
+    CovDbItem                                   *m_items;
+    char                                        *m_names;
+    std::atomic<uint64_t>                       *m_bins;
+    mutable std::mutex                          m_mutex;
+    std::unordered_map<std::string, uint32_t>   m_item_m;
+
+};
+
+}
+}
+
+
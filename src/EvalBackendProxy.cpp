@@ -18,6 +18,7 @@
  * Created on:
  *     Author:
  */
+#include "Actor.h"
 #include "EvalBackendProxy.h"
 #include "ZuspecSvDpiImp.h"
 
@@ -26,7 +27,7 @@ namespace zsp {
 namespace sv {
 
 
-EvalBackendProxy::EvalBackendProxy() {
+EvalBackendProxy::EvalBackendProxy() : m_actor(0) {
 
 }
 
@@ -38,22 +39,36 @@ void EvalBackendProxy::callFuncReq(
             arl::eval::IEvalThread              *thread,
             arl::dm::IDataTypeFunction          *func_t,
             const std::vector<vsc::dm::ValRef>  &params) {
-    // TODO: handle multiple outstanding per-thread calls
-    m_params.clear();
-    for (std::vector<vsc::dm::ValRef>::const_iterator
-        it=params.begin();
-        it!=params.end(); it++) {
-        m_params.push_back(*it);
-    }
+    m_actor->callIssued(thread, func_t);
+
+    Arena &pool = m_actor->callParams(thread);
+    ValRefList *list = pool.mk<ValRefList>();
+    list->size = params.size();
+    list->items = pool.mkArray<vsc::dm::ValRef>(params.size(), params.data());
+
     zuspec_EvalBackendProxy_callFuncReq(
         reinterpret_cast<chandle>(this),
         reinterpret_cast<chandle>(thread),
         reinterpret_cast<chandle>(func_t),
         !func_t->hasFlags(arl::dm::DataTypeFunctionFlags::Solve),
-        reinterpret_cast<chandle>(&m_params)
+        reinterpret_cast<chandle>(list)
     );
 }
 
+void EvalBackendProxy::enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_actor->actionStart(thread, action_t, action_v);
+}
+
+void EvalBackendProxy::leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_actor->actionComplete(thread, action_t, action_v);
+}
+
 void EvalBackendProxy::emitMessage(const std::string &msg) {
     zuspec_EvalBackendProxy_emitMessage(
         reinterpret_cast<chandle>(this),
@@ -64,20 +79,17 @@ void EvalBackendProxy::emitMessage(const std::string &msg) {
 }
 }
 
-extern "C" uint64_t zuspec_EvalBackendProxy_new() {
+ZUSPEC_DPI_EXPORT uint64_t zuspec_EvalBackendProxy_new() {
     return reinterpret_cast<uint64_t>(new zsp::sv::EvalBackendProxy());
 }
 
-extern "C" int32_t zuspec_ValRefList_size(chandle list_h) {
-    std::vector<vsc::dm::ValRef> *list = 
-        reinterpret_cast<std::vector<vsc::dm::ValRef> *>(list_h);
-    return list->size();
+ZUSPEC_DPI_EXPORT int32_t zuspec_ValRefList_size(chandle list_h) {
+    return reinterpret_cast<zsp::sv::ValRefList *>(list_h)->size;
 }
 
-extern "C" chandle zuspec_ValRefList_at(
+ZUSPEC_DPI_EXPORT chandle zuspec_ValRefList_at(
     chandle     list_h,
     int32_t     idx) {
-    std::vector<vsc::dm::ValRef> *list = 
-        reinterpret_cast<std::vector<vsc::dm::ValRef> *>(list_h);
-    return reinterpret_cast<chandle>(&list->at(idx));
+    zsp::sv::ValRefList *list = reinterpret_cast<zsp::sv::ValRefList *>(list_h);
+    return reinterpret_cast<chandle>(&list->items[idx]);
 }
@@ -19,12 +19,22 @@
  *     Author: 
  */
 #pragma once
+#include <vector>
 #include "zsp/arl/eval/impl/EvalBackendBase.h"
 
 namespace zsp {
 namespace sv {
 
+class Actor;
 
+/**
+ * Parameters of an outstanding call, as seen by SV. Allocated in the 
+ * call's parameter pool, and valid until the call completes
+ */
+struct ValRefList {
+    int32_t                                     size;
+    vsc::dm::ValRef                             *items;
+};
 
 class EvalBackendProxy : public virtual arl::eval::EvalBackendBase {
 public:
@@ -37,10 +47,24 @@ public:
             arl::dm::IDataTypeFunction          *func_t,
             const std::vector<vsc::dm::ValRef>  &params) override;
 
+    virtual void enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
     virtual void emitMessage(const std::string &msg) override;
 
+    void setActor(Actor *actor) {
+        m_actor = actor;
+    }
+
 private:
-    std::vector<vsc::dm::ValRef>                m_params;
+    Actor                                       *m_actor;
 
 };
 
@@ -0,0 +1,147 @@
+/*
+ * Factory.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include "Actor.h"
+#include "Factory.h"
+#include "ZuspecSv.h"
+#include "ZuspecSvDpiImp.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+Factory::Factory() {
+
+}
+
+Factory::~Factory() {
+
+}
+
+bool Factory::init(
+        const std::string           &pss_files,
+        bool                        debug) {
+    return ZuspecSv::inst()->init(pss_files, false, debug);
+}
+
+bool Factory::load() {
+    return ZuspecSv::inst()->ensureLoaded();
+}
+
+IBackend *Factory::mkBackend() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_backends.push_back(NativeBackendUP(new NativeBackend()));
+    return m_backends.back().get();
+}
+
+IActor *Factory::mkActor(
+        const std::string           &seed,
+        const std::string           &comp_t,
+        const std::string           &action_t,
+        IBackend                    *backend) {
+    NativeBackend *backend_n = dynamic_cast<NativeBackend *>(backend);
+
+    if (!backend_n) {
+        emitMessage(MessageLevel::Error, "mkActor: backend was not created by mkBackend");
+        return 0;
+    }
+
+    if (!backend_n->claim()) {
+        emitMessage(MessageLevel::Error, 
+            "mkActor: backend is already bound to an actor. Create a backend per actor");
+        return 0;
+    }
+
+    Actor *actor = ZuspecSv::inst()->mkActor(
+        0,
+        seed,
+        comp_t,
+        action_t,
+        backend_n);
+
+    if (actor) {
+        backend_n->setActor(actor);
+    } else {
+        backend_n->release();
+    }
+
+    return actor;
+}
+
+void Factory::setMessageHandler(const MessageHandler &handler) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_handler = handler;
+}
+
+void Factory::emitMessage(
+        MessageLevel                level,
+        const std::string           &msg) {
+    MessageHandler handler;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (level != MessageLevel::Info) {
+            m_last_error = msg;
+        }
+        handler = m_handler;
+    }
+
+    // Called without the lock, so that the handler may call back into
+    // the factory
+    if (handler) {
+        handler(level, msg);
+    } else {
+        switch (level) {
+            case MessageLevel::Info:
+                fprintf(stdout, "ZuspecSv: %s\n", msg.c_str());
+                break;
+            case MessageLevel::Error:
+                fprintf(stdout, "ZuspecSv ERROR: %s\n", msg.c_str());
+                break;
+            case MessageLevel::Fatal:
+                fprintf(stdout, "ZuspecSv FATAL: %s\n", msg.c_str());
+                break;
+        }
+        fflush(stdout);
+    }
+}
+
+std::string Factory::getLastError() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_last_error;
+}
+
+Factory *Factory::inst() {
+    std::call_once(m_inst_once, []() {
+        m_inst = FactoryUP(new Factory());
+    });
+    return m_inst.get();
+}
+
+FactoryUP Factory::m_inst;
+std::once_flag Factory::m_inst_once;
+
+}
+}
+
+ZUSPEC_DPI_EXPORT zsp::sv::IFactory *zsp_sv_getFactory() {
+    return zsp::sv::Factory::inst();
+}
@@ -0,0 +1,76 @@
+/**
+ * Factory.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "zsp/sv/IFactory.h"
+#include "NativeBackend.h"
+
+namespace zsp {
+namespace sv {
+
+class Factory;
+using FactoryUP=std::unique_ptr<Factory>;
+class Factory : public virtual IFactory {
+public:
+    Factory();
+
+    virtual ~Factory();
+
+    virtual bool init(
+        const std::string           &pss_files,
+        bool                        debug) override;
+
+    virtual bool load() override;
+
+    virtual IBackend *mkBackend() override;
+
+    virtual IActor *mkActor(
+        const std::string           &seed,
+        const std::string           &comp_t,
+        const std::string           &action_t,
+        IBackend                    *backend) override;
+
+    virtual void setMessageHandler(const MessageHandler &handler) override;
+
+    virtual void emitMessage(
+        MessageLevel                level,
+        const std::string           &msg) override;
+
+    virtual std::string getLastError() const override;
+
+    static Factory *inst();
+
+private:
+    static FactoryUP                        m_inst;
+    static std::once_flag                   m_inst_once;
+    mutable std::mutex                      m_mutex;
+    std::vector<NativeBackendUP>            m_backends;
+    MessageHandler                          m_handler;
+    std::string                             m_last_error;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,327 @@
+/*
+ * HeapProf.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+#ifdef ZUSPEC_SV_HEAPPROF
+#include <malloc.h>
+#endif
+#include "HeapProf.h"
+#include "ZuspecSvDpiImp.h"
+
+
+namespace zsp {
+namespace sv {
+
+static thread_local HeapStats           *prv_current = 0;
+static std::mutex                       prv_phases_mutex;
+// Set by this library's operator new, so only once it is in effect
+static std::atomic<bool>                prv_interposed(false);
+
+static std::vector<HeapStats *> &phases() {
+    static std::vector<HeapStats *> phases;
+    return phases;
+}
+
+static std::vector<HeapStats *> &scopes() {
+    static std::vector<HeapStats *> scopes;
+    return scopes;
+}
+
+bool HeapProf::built() {
+#ifdef ZUSPEC_SV_HEAPPROF
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool HeapProf::interposed() {
+#ifdef ZUSPEC_SV_HEAPPROF
+    // Calls to operator new, including this library's own, bind to the 
+    // first definition in the global scope. Counting only happens when
+    // that definition is the one in this library, which a probe reveals
+    if (!prv_interposed.load(std::memory_order_relaxed)) {
+        void *volatile p = ::operator new(1);
+        ::operator delete(p);
+    }
+    return prv_interposed.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+}
+
+bool HeapProf::enabled() {
+    return built() && interposed();
+}
+
+HeapStats *HeapProf::current() {
+    return prv_current;
+}
+
+HeapStats *HeapProf::setCurrent(HeapStats *stats) {
+    HeapStats *prev = prv_current;
+    prv_current = stats;
+    return prev;
+}
+
+HeapStats *HeapProf::phase(const std::string &name) {
+    std::lock_guard<std::mutex> lock(prv_phases_mutex);
+    for (std::vector<HeapStats *>::const_iterator
+        it=phases().begin();
+        it!=phases().end(); it++) {
+        if ((*it)->name == name) {
+            return *it;
+        }
+    }
+    // Phase counters live for the life of the process
+    phases().push_back(new HeapStats(name));
+    return phases().back();
+}
+
+HeapStats *HeapProf::mkScope(const std::string &name) {
+    std::lock_guard<std::mutex> lock(prv_phases_mutex);
+    scopes().push_back(new HeapStats(name));
+    return scopes().back();
+}
+
+HeapStats *HeapProf::total() {
+    static HeapStats total("total");
+    return &total;
+}
+
+static void report_stats(const HeapStats *s) {
+    char tmp[1024];
+    snprintf(tmp, sizeof(tmp),
+        "Heap: %-24s alloc=%llu (%llu allocs) free=%llu (%llu frees) net=%llu",
+        s->name.c_str(),
+        (unsigned long long)s->alloc_bytes,
+        (unsigned long long)s->alloc_count,
+        (unsigned long long)s->free_bytes,
+        (unsigned long long)s->free_count,
+        (unsigned long long)s->liveBytes());
+    zuspec_message(tmp);
+}
+
+void HeapProf::report() {
+    if (!built()) {
+        zuspec_message("Heap: profiling not enabled (rebuild with ZUSPEC_SV_HEAPPROF)");
+        return;
+    } else if (!interposed()) {
+        zuspec_message(
+            "Heap: profiling inactive: operator new is not interposed "
+            "(LD_PRELOAD the zsp-sv library)");
+        return;
+    }
+
+    report_stats(total());
+
+    std::lock_guard<std::mutex> lock(prv_phases_mutex);
+    for (std::vector<HeapStats *>::const_iterator
+        it=phases().begin();
+        it!=phases().end(); it++) {
+        report_stats(*it);
+    }
+}
+
+#ifdef ZUSPEC_SV_HEAPPROF
+HeapStats *HeapProf::onAlloc(uint64_t sz) {
+    HeapStats *s = prv_current;
+    if (!prv_interposed.load(std::memory_order_relaxed)) {
+        prv_interposed.store(true, std::memory_order_relaxed);
+    }
+    total()->alloc_bytes.fetch_add(sz, std::memory_order_relaxed);
+    total()->alloc_count.fetch_add(1, std::memory_order_relaxed);
+    if (s) {
+        s->alloc_bytes.fetch_add(sz, std::memory_order_relaxed);
+        s->alloc_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    return s;
+}
+
+void HeapProf::onFree(HeapStats *owner, uint64_t sz) {
+    total()->free_bytes.fetch_add(sz, std::memory_order_relaxed);
+    total()->free_count.fetch_add(1, std::memory_order_relaxed);
+    if (owner) {
+        owner->free_bytes.fetch_add(sz, std::memory_order_relaxed);
+        owner->free_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+#else
+HeapStats *HeapProf::onAlloc(uint64_t) { return 0; }
+
+void HeapProf::onFree(HeapStats *, uint64_t) { }
+#endif
+
+}
+}
+
+#ifdef ZUSPEC_SV_HEAPPROF
+/****************************************************************************
+ * Counting allocator
+ *
+ * Global operator new/delete are only interposed when this library is 
+ * found ahead of libstdc++ in the global symbol scope, which requires
+ * LD_PRELOAD since simulators load libstdc++ first. Otherwise, even this
+ * library's own allocations bind to libstdc++ and nothing is counted
+ * (see HeapProf::interposed). The operators are exported even from the
+ * bundle, whose other symbols are hidden: a private operator new would 
+ * hand out blocks that libstdc++'s operator delete then frees.
+ *
+ * Each block's scope is recorded in a side table keyed by the block's 
+ * address, so that its free is charged there. Blocks not in the table 
+ * (allocated by a non-interposed operator new) are passed to free as-is,
+ * without reading outside them. The table is sharded to keep contention
+ * low, and its records come from malloc, never from operator new.
+ ****************************************************************************/
+
+#define ZSP_SV_HEAPPROF_EXPORT __attribute__((visibility("default")))
+
+struct AllocRec {
+    void                        *p;
+    zsp::sv::HeapStats          *owner;
+    AllocRec                    *next;
+};
+
+// Zero-initialized, so usable by allocations during static initialization
+struct AllocShard {
+    std::mutex                  mutex;
+    // Hash chains, allocated on first use
+    AllocRec                    **buckets;
+    // Records of freed blocks, for reuse
+    AllocRec                    *free_l;
+};
+
+static const uint32_t   ALLOC_SHARDS = 64;
+static const uint32_t   ALLOC_BUCKETS = 4096;
+
+static AllocShard       prv_shards[ALLOC_SHARDS];
+
+static AllocShard &prv_shard(void *p, AllocRec **&bucket) {
+    uint64_t h = (reinterpret_cast<uintptr_t>(p) >> 4) * 0x9E3779B97F4A7C15ULL;
+    AllocShard &shard = prv_shards[h >> 58];
+    bucket = (shard.buckets)?&shard.buckets[(h >> 32) % ALLOC_BUCKETS]:0;
+    return shard;
+}
+
+static bool prv_track(void *p) {
+    AllocRec **bucket;
+    AllocShard &shard = prv_shard(p, bucket);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (!shard.buckets) {
+        shard.buckets = reinterpret_cast<AllocRec **>(
+            calloc(ALLOC_BUCKETS, sizeof(AllocRec *)));
+        if (!shard.buckets) {
+            return false;
+        }
+        prv_shard(p, bucket);
+    }
+
+    AllocRec *rec = shard.free_l;
+    if (rec) {
+        shard.free_l = rec->next;
+    } else if (!(rec = reinterpret_cast<AllocRec *>(malloc(sizeof(AllocRec))))) {
+        return false;
+    }
+    rec->p = p;
+    rec->owner = zsp::sv::HeapProf::onAlloc(malloc_usable_size(p));
+    rec->next = *bucket;
+    *bucket = rec;
+    return true;
+}
+
+static void *prv_alloc_nothrow(size_t sz) {
+    void *p = malloc(sz?sz:1);
+    if (p && !prv_track(p)) {
+        free(p);
+        p = 0;
+    }
+    return p;
+}
+
+static void *prv_alloc(size_t sz) {
+    void *p = prv_alloc_nothrow(sz);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+static void prv_free(void *p) {
+    if (!p) {
+        return;
+    }
+    AllocRec **bucket;
+    AllocShard &shard = prv_shard(p, bucket);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (AllocRec **rp=bucket; rp && *rp; rp=&(*rp)->next) {
+            if ((*rp)->p == p) {
+                AllocRec *rec = *rp;
+                *rp = rec->next;
+                zsp::sv::HeapProf::onFree(rec->owner, malloc_usable_size(p));
+                rec->next = shard.free_l;
+                shard.free_l = rec;
+                break;
+            }
+        }
+    }
+    free(p);
+}
+
+ZSP_SV_HEAPPROF_EXPORT void *operator new(size_t sz) {
+    return prv_alloc(sz);
+}
+
+ZSP_SV_HEAPPROF_EXPORT void *operator new[](size_t sz) {
+    return prv_alloc(sz);
+}
+
+ZSP_SV_HEAPPROF_EXPORT void *operator new(size_t sz, const std::nothrow_t &) noexcept {
+    return prv_alloc_nothrow(sz);
+}
+
+ZSP_SV_HEAPPROF_EXPORT void *operator new[](size_t sz, const std::nothrow_t &) noexcept {
+    return prv_alloc_nothrow(sz);
+}
+
+ZSP_SV_HEAPPROF_EXPORT void operator delete(void *p) noexcept {
+    prv_free(p);
+}
+
+ZSP_SV_HEAPPROF_EXPORT void operator delete[](void *p) noexcept {
+    prv_free(p);
+}
+
+ZSP_SV_HEAPPROF_EXPORT void operator delete(void *p, size_t) noexcept {
+    prv_free(p);
+}
+
+ZSP_SV_HEAPPROF_EXPORT void operator delete[](void *p, size_t) noexcept {
+    prv_free(p);
+}
+#endif /* ZUSPEC_SV_HEAPPROF */
+
@@ -0,0 +1,122 @@
+/**
+ * HeapProf.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <atomic>
+#include <stdint.h>
+#include <string>
+
+namespace zsp {
+namespace sv {
+
+
+/**
+ * Allocation counters for one attribution scope (a load phase or an actor).
+ * Frees are charged to the scope that made the allocation, which is
+ * recorded for the block. Counters therefore live for the process.
+ */
+struct HeapStats {
+    HeapStats(const std::string &name) : name(name),
+        alloc_bytes(0), alloc_count(0), free_bytes(0), free_count(0) { }
+
+    uint64_t liveBytes() const {
+        uint64_t a = alloc_bytes, f = free_bytes;
+        return (a > f)?(a - f):0;
+    }
+
+    std::string                 name;
+    std::atomic<uint64_t>       alloc_bytes;
+    std::atomic<uint64_t>       alloc_count;
+    std::atomic<uint64_t>       free_bytes;
+    std::atomic<uint64_t>       free_count;
+};
+
+class HeapProf {
+public:
+
+    /**
+     * Returns true when the library was built with ZUSPEC_SV_HEAPPROF
+     */
+    static bool built();
+
+    /**
+     * Returns true when this library's operator new is the one in effect:
+     * when it has been called, or a probe allocation reaches it. Requires
+     * LD_PRELOAD of the library, unless it is linked into the executable
+     */
+    static bool interposed();
+
+    /**
+     * Returns true when allocations are being counted: the library was 
+     * built with ZUSPEC_SV_HEAPPROF and its allocator is interposed
+     */
+    static bool enabled();
+
+    static HeapStats *current();
+
+    /**
+     * Sets the scope charged for allocations on the calling thread.
+     * Returns the previously-active scope
+     */
+    static HeapStats *setCurrent(HeapStats *stats);
+
+    /**
+     * Returns the (process-lifetime) counters for a named load phase
+     */
+    static HeapStats *phase(const std::string &name);
+
+    /**
+     * Creates process-lifetime counters for another scope (eg an actor).
+     * They outlive the scope, since its blocks may be freed later
+     */
+    static HeapStats *mkScope(const std::string &name);
+
+    static HeapStats *total();
+
+    static void report();
+
+    /**
+     * Charges an allocation to the current scope, and returns that scope
+     */
+    static HeapStats *onAlloc(uint64_t sz);
+
+    /**
+     * Charges a free to the scope that made the allocation
+     */
+    static void onFree(HeapStats *owner, uint64_t sz);
+
+};
+
+class HeapScope {
+public:
+    HeapScope(HeapStats *stats) : m_prev(HeapProf::setCurrent(stats)) { }
+
+    ~HeapScope() {
+        HeapProf::setCurrent(m_prev);
+    }
+
+private:
+    HeapStats                   *m_prev;
+};
+
+}
+}
+
+
@@ -0,0 +1,176 @@
+/*
+ * JournalFile.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <string.h>
+#include "JournalFile.h"
+
+
+namespace zsp {
+namespace sv {
+
+static const char JOURNAL_MAGIC[8] = {'Z','S','P','C','K','P','T','\0'};
+
+static void put_le(uint8_t *buf, uint64_t v, uint32_t sz) {
+    for (uint32_t i=0; i<sz; i++) {
+        buf[i] = static_cast<uint8_t>(v >> (8*i));
+    }
+}
+
+static uint64_t get_le(const uint8_t *buf, uint32_t sz) {
+    uint64_t v = 0;
+    for (uint32_t i=sz; i>0; i--) {
+        v = (v << 8) | buf[i-1];
+    }
+    return v;
+}
+
+static void write_le(FILE *fp, uint64_t v, uint32_t sz) {
+    uint8_t buf[8];
+    put_le(buf, v, sz);
+    fwrite(buf, 1, sz, fp);
+}
+
+template <class T> static bool read_le(FILE *fp, T &v) {
+    uint8_t buf[sizeof(T)];
+    if (fread(buf, 1, sizeof(T), fp) != sizeof(T)) {
+        return false;
+    }
+    v = static_cast<T>(get_le(buf, sizeof(T)));
+    return true;
+}
+
+static void write_str(FILE *fp, const std::string &s) {
+    write_le(fp, s.size(), 4);
+    fwrite(s.c_str(), 1, s.size(), fp);
+}
+
+static bool read_str(FILE *fp, std::string &s) {
+    uint32_t len;
+    if (!read_le(fp, len)) {
+        return false;
+    }
+    s.resize(len);
+    return (len == 0 || fread(&s[0], 1, len, fp) == len);
+}
+
+void JournalFile::pack(const JournalEvent &ev, uint8_t *buf) {
+    put_le(&buf[0], ev.kind, 1);
+    put_le(&buf[1], ev.is_signed, 1);
+    put_le(&buf[2], ev.width, 2);
+    put_le(&buf[4], static_cast<uint64_t>(ev.at_call), 8);
+    put_le(&buf[12], ev.call, 8);
+    put_le(&buf[20], static_cast<uint64_t>(ev.value), 8);
+}
+
+void JournalFile::unpack(const uint8_t *buf, JournalEvent &ev) {
+    ev.kind = static_cast<uint8_t>(get_le(&buf[0], 1));
+    ev.is_signed = static_cast<uint8_t>(get_le(&buf[1], 1));
+    ev.width = static_cast<uint16_t>(get_le(&buf[2], 2));
+    ev.at_call = static_cast<int64_t>(get_le(&buf[4], 8));
+    ev.call = get_le(&buf[12], 8);
+    ev.value = static_cast<int64_t>(get_le(&buf[20], 8));
+}
+
+bool JournalFile::write(
+        FILE                                *fp,
+        const JournalHeader                 &hdr,
+        FILE                                *packed,
+        uint64_t                            n_packed,
+        const std::vector<JournalEvent>     &events) {
+    uint8_t buf[EventSize];
+    bool ok = true;
+
+    fwrite(JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC), 1, fp);
+    write_le(fp, Version, 4);
+    write_str(fp, hdr.comp_t);
+    write_str(fp, hdr.action_t);
+    write_str(fp, hdr.setup);
+    write_str(fp, hdr.seed);
+    write_le(fp, hdr.reseeds.size(), 4);
+    for (std::vector<std::string>::const_iterator
+        it=hdr.reseeds.begin();
+        it!=hdr.reseeds.end(); it++) {
+        write_str(fp, *it);
+    }
+    write_le(fp, hdr.n_calls, 8);
+    write_le(fp, n_packed + events.size(), 8);
+
+    if (packed && n_packed) {
+        ok = (fseek(packed, 0, SEEK_SET) == 0);
+        for (uint64_t i=0; ok && i<n_packed; i++) {
+            ok = (fread(buf, 1, EventSize, packed) == EventSize);
+            fwrite(buf, 1, EventSize, fp);
+        }
+        fseek(packed, n_packed*EventSize, SEEK_SET);
+    }
+
+    for (std::vector<JournalEvent>::const_iterator
+        it=events.begin();
+        it!=events.end(); it++) {
+        pack(*it, buf);
+        fwrite(buf, 1, EventSize, fp);
+    }
+
+    return (ok && !ferror(fp));
+}
+
+bool JournalFile::read(
+        FILE                                *fp,
+        JournalHeader                       &hdr,
+        std::vector<JournalEvent>           &events) {
+    char magic[sizeof(JOURNAL_MAGIC)];
+    uint8_t buf[EventSize];
+    uint32_t version = 0, n_reseeds = 0;
+    uint64_t n_events = 0;
+
+    bool ok = (fread(magic, sizeof(magic), 1, fp) == 1
+        && !memcmp(magic, JOURNAL_MAGIC, sizeof(magic))
+        && read_le(fp, version)
+        && version == Version
+        && read_str(fp, hdr.comp_t)
+        && read_str(fp, hdr.action_t)
+        && read_str(fp, hdr.setup)
+        && read_str(fp, hdr.seed)
+        && read_le(fp, n_reseeds));
+
+    hdr.reseeds.clear();
+    for (uint32_t i=0; ok && i<n_reseeds; i++) {
+        hdr.reseeds.push_back("");
+        ok = read_str(fp, hdr.reseeds.back());
+    }
+
+    ok = ok && read_le(fp, hdr.n_calls) && read_le(fp, n_events);
+
+    // The count is not trusted for the allocation, since the file may
+    // be truncated
+    events.clear();
+    for (uint64_t i=0; ok && i<n_events; i++) {
+        if ((ok = (fread(buf, 1, EventSize, fp) == EventSize))) {
+            events.push_back(JournalEvent());
+            unpack(buf, events.back());
+        }
+    }
+
+    return ok;
+}
+
+}
+}
+
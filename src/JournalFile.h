@@ -0,0 +1,101 @@
+/**
+ * JournalFile.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace zsp {
+namespace sv {
+
+struct JournalEvent {
+    enum Kind : uint8_t { Eval, VoidResult, IntResult, Reseed };
+
+    uint8_t         kind;
+    uint8_t         is_signed;
+    uint16_t        width;
+    // Call whose request was being dispatched when the event occurred,
+    // or -1 if none. Nested events are replayed inside that request
+    int64_t         at_call;
+    // Completed call, or seed index for Reseed
+    uint64_t        call;
+    // Call result, or for Eval the step count at which a budgeted eval
+    // yielded (0 if it did not)
+    int64_t         value;
+};
+
+/**
+ * Everything in a journal file other than its events
+ */
+struct JournalHeader {
+    std::string                 comp_t;
+    std::string                 action_t;
+    // Actor configuration before its first eval
+    std::string                 setup;
+    std::string                 seed;
+    std::vector<std::string>    reseeds;
+    uint64_t                    n_calls;
+};
+
+/**
+ * Reads and writes actor journals (checkpoints). Every field is written
+ * explicitly, little-endian and at a fixed width, so that a checkpoint
+ * doesn't depend on the struct layout or byte order of the host that
+ * saved it. Events are stored back to back, EventSize bytes each
+ */
+class JournalFile {
+public:
+    static const uint32_t   Version = 4;
+    static const uint32_t   EventSize = 28;
+
+    static void pack(const JournalEvent &ev, uint8_t *buf);
+
+    static void unpack(const uint8_t *buf, JournalEvent &ev);
+
+    /**
+     * Writes a journal to 'fp'. Its events are 'n_packed' events read
+     * from the start of 'packed' (if not null), already in file form, 
+     * followed by 'events'. 'packed' is left positioned after the 
+     * events read. Returns false on a write or read error
+     */
+    static bool write(
+        FILE                                *fp,
+        const JournalHeader                 &hdr,
+        FILE                                *packed,
+        uint64_t                            n_packed,
+        const std::vector<JournalEvent>     &events);
+
+    /**
+     * Reads a journal written by write(). Returns false if the file is
+     * truncated or not a journal of this version
+     */
+    static bool read(
+        FILE                                *fp,
+        JournalHeader                       &hdr,
+        std::vector<JournalEvent>           &events);
+
+};
+
+}
+}
+
+
@@ -20,6 +20,7 @@
  */
 #include <string.h>
 #include "MarkerListener.h"
+#include "Model.h"
 #include "ZuspecSvDpiImp.h"
 
 
@@ -27,7 +28,7 @@ namespace zsp {
 namespace sv {
 
 
-MarkerListener::MarkerListener() {
+MarkerListener::MarkerListener(Model *model) : m_model(model) {
     memset(m_hasSeverity, 0, sizeof(m_hasSeverity));
 }
 
@@ -37,7 +38,11 @@ MarkerListener::~MarkerListener() {
 
 void MarkerListener::marker(const zsp::parser::IMarker *m) {
     m_hasSeverity[(int)m->severity()] = true;
-    zuspec_error(m->msg().c_str());
+    if (m_model) {
+        m_model->message(Model::MessageLevel::Error, m->msg());
+    } else {
+        zuspec_error(m->msg().c_str());
+    }
 }
 
 bool MarkerListener::hasSeverity(zsp::parser::MarkerSeverityE s) {
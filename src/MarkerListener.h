@@ -25,9 +25,11 @@ namespace zsp {
 namespace sv {
 
 
+class Model;
+
 class MarkerListener : public virtual zsp::parser::IMarkerListener {
 public:
-    MarkerListener();
+    MarkerListener(Model *model=0);
 
     virtual ~MarkerListener();
 
@@ -36,6 +38,7 @@ public:
 	virtual bool hasSeverity(zsp::parser::MarkerSeverityE s) override;
 
 private:
+    Model                       *m_model;
     bool                        m_hasSeverity[(int)zsp::parser::MarkerSeverityE::NumLevels];
 
 };
@@ -0,0 +1,235 @@
+/*
+ * Model.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include <fstream>
+#include "zsp/parser/FactoryExt.h"
+#include "zsp/fe/parser/FactoryExt.h"
+#include "HeapProf.h"
+#include "MarkerListener.h"
+#include "Model.h"
+#include "Probes.h"
+#include "ZuspecSvDpiImp.h"
+
+namespace zsp {
+namespace sv {
+
+// The parser and front-end factories, and the debug manager they report
+// through, are shared by all models and not known to be thread-safe
+static std::mutex                       prv_load_mutex;
+
+/**
+ * Tracks the active load phase for heap attribution and tracing
+ */
+class LoadPhase {
+public:
+    LoadPhase(const char *name) : m_name(0), m_heap(HeapProf::current()) {
+        next(name);
+    }
+
+    ~LoadPhase() {
+        next(0);
+        HeapProf::setCurrent(m_heap);
+    }
+
+    void next(const char *name) {
+        if (m_name) {
+            ZSP_SV_PROBE1(load_phase_exit, m_name);
+        }
+        m_name = name;
+        if (m_name) {
+            ZSP_SV_PROBE1(load_phase_enter, m_name);
+            HeapProf::setCurrent(HeapProf::phase(m_name));
+        }
+    }
+
+private:
+    const char                  *m_name;
+    HeapStats                   *m_heap;
+};
+
+Model::Model(
+        dmgr::IDebugMgr         *dmgr,
+        const std::string       &name,
+        const std::string       &pss_files,
+        arl::dm::IContext       *ctxt) :
+            m_dmgr(dmgr), m_name(name), m_pssfiles(pss_files), m_ctxt(ctxt),
+            m_state(LoadState::Unloaded), m_async(false), m_load_ok(false) {
+
+}
+
+Model::~Model() {
+    if (m_load_t.joinable()) {
+        m_load_t.join();
+    }
+}
+
+void Model::loadAsync() {
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    if (m_state != LoadState::Unloaded) {
+        return;
+    }
+    m_state = LoadState::Loading;
+    m_async = true;
+    m_load_t = std::thread([this]() {
+        m_load_ok = load();
+    });
+}
+
+bool Model::ensureLoaded() {
+    std::lock_guard<std::mutex> lock(m_load_mutex);
+    switch (m_state) {
+        case LoadState::Unloaded:
+            m_state = (load())?LoadState::Loaded:LoadState::Failed;
+            break;
+        case LoadState::Loading:
+            m_load_t.join();
+            m_state = (m_load_ok)?LoadState::Loaded:LoadState::Failed;
+            m_async = false;
+            flushMessages();
+            break;
+        default:
+            break;
+    }
+    return (m_state == LoadState::Loaded);
+}
+
+void Model::message(MessageLevel level, const std::string &msg) {
+    if (m_async) {
+        std::lock_guard<std::mutex> lock(m_msg_mutex);
+        m_msgs.push_back({level, msg});
+        return;
+    }
+
+    switch (level) {
+        case MessageLevel::Info: zuspec_message(msg.c_str()); break;
+        case MessageLevel::Error: zuspec_error(msg.c_str()); break;
+        case MessageLevel::Fatal: zuspec_fatal(msg.c_str()); break;
+    }
+}
+
+void Model::flushMessages() {
+    std::vector<std::pair<MessageLevel,std::string>> msgs;
+    {
+        std::lock_guard<std::mutex> lock(m_msg_mutex);
+        msgs.swap(m_msgs);
+    }
+    for (std::vector<std::pair<MessageLevel,std::string>>::const_iterator
+        it=msgs.begin();
+        it!=msgs.end(); it++) {
+        message(it->first, it->second);
+    }
+}
+
+bool Model::load() {
+    char tmp[1024];
+
+    if (m_pssfiles == "") {
+        message(MessageLevel::Info, "No PSS files specified");
+        return false;
+    }
+
+    if (m_name == "") {
+        snprintf(tmp, sizeof(tmp), "Parsing %s", m_pssfiles.c_str());
+    } else {
+        snprintf(tmp, sizeof(tmp), "Parsing %s (model %s)", 
+            m_pssfiles.c_str(), m_name.c_str());
+    }
+    message(MessageLevel::Info, tmp);
+
+    // Loads of different models are serialized. A background load still
+    // overlaps with simulation
+    std::lock_guard<std::mutex> lock(prv_load_mutex);
+    MarkerListener listener(this);
+    LoadPhase phase("load.stdlib");
+    parser::IFactory *parser_f = zsp_parser_getFactory();
+    parser::IAstBuilderUP builder(parser_f->mkAstBuilder(&listener));
+    std::vector<ast::IGlobalScopeUP> scopes;
+
+    scopes.push_back(parser_f->getAstFactory()->mkGlobalScope(0));
+    parser_f->loadStandardLibrary(builder.get(), scopes.back().get());
+
+    phase.next("load.parse");
+
+    scopes.push_back(parser_f->getAstFactory()->mkGlobalScope(1));
+
+
+    std::fstream s;
+
+    s.open(m_pssfiles, std::fstream::in);
+
+    if (!s.is_open()) {
+        snprintf(tmp, sizeof(tmp), "Failed to open file %s", m_pssfiles.c_str());
+        message(MessageLevel::Fatal, tmp);
+        return false;
+    }
+
+    builder->build(
+        scopes.back().get(),
+        &s);
+    
+    if (listener.hasSeverity(parser::MarkerSeverityE::Error)) {
+        message(MessageLevel::Fatal, "Parse errors");
+        return false;
+    }
+    
+    std::vector<ast::IGlobalScope *> scopes_p;
+    for (std::vector<ast::IGlobalScopeUP>::const_iterator
+        it=scopes.begin();
+        it!=scopes.end(); it++) {
+        scopes_p.push_back(it->get());
+    }
+
+    phase.next("load.link");
+    parser::ILinkerUP linker(parser_f->mkAstLinker());
+    ast::ISymbolScopeUP scope(linker->link(
+        &listener,
+        scopes_p
+    ));
+
+    if (listener.hasSeverity(parser::MarkerSeverityE::Error)) {
+        message(MessageLevel::Fatal, "Linking errors");
+        return false;
+    }
+
+    phase.next("load.build");
+    fe::parser::IFactory *fe_parser_f = zsp_fe_parser_getFactory();
+    fe::parser::IAst2ArlContextUP builder_ctxt(fe_parser_f->mkAst2ArlContext(
+        m_ctxt.get(),
+        scope.get(),
+        &listener
+    ));
+    fe::parser::IAst2ArlBuilderUP fe_builder(fe_parser_f->mkAst2ArlBuilder());
+    fe_builder->build(
+        scope.get(),
+        builder_ctxt.get()
+    );
+
+    if (listener.hasSeverity(parser::MarkerSeverityE::Error)) {
+        message(MessageLevel::Fatal, "Data-model build errors");
+        return false;
+    }
+
+
+    return true;
+}
+
+}
+}
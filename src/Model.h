@@ -0,0 +1,124 @@
+/**
+ * Model.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "dmgr/IDebugMgr.h"
+#include "zsp/arl/dm/IContext.h"
+
+namespace zsp {
+namespace sv {
+
+/**
+ * A PSS model: a set of source files and the data-model context they are
+ * elaborated into. Models are independent, and may be loaded on a 
+ * background thread while simulation proceeds. Since parsing goes 
+ * through factories shared by all models, loads of different models 
+ * run one at a time
+ */
+class Model;
+using ModelUP=std::unique_ptr<Model>;
+class Model {
+public:
+    enum class MessageLevel { Info, Error, Fatal };
+
+    Model(
+        dmgr::IDebugMgr         *dmgr,
+        const std::string       &name,
+        const std::string       &pss_files,
+        arl::dm::IContext       *ctxt);
+
+    virtual ~Model();
+
+    const std::string &name() const {
+        return m_name;
+    }
+
+    const std::string &getPssFiles() const {
+        return m_pssfiles;
+    }
+
+    void setPssFiles(const std::string &pss_files) {
+        m_pssfiles = pss_files;
+    }
+
+    arl::dm::IContext *ctxt() const {
+        return m_ctxt.get();
+    }
+
+    /**
+     * Serializes elaboration into the context and type lookups. 
+     * Elaboration may add types to the context, so every actor of the
+     * model must hold this while building an evaluation context
+     */
+    std::mutex &elabMutex() {
+        return m_elab_mutex;
+    }
+
+    /**
+     * Starts loading on a background thread. Messages produced while 
+     * loading are held until ensureLoaded() is called
+     */
+    void loadAsync();
+
+    /**
+     * Loads the model, or waits for a background load to complete.
+     * Must be called from the simulator thread
+     */
+    bool ensureLoaded();
+
+    /**
+     * Reports a load message. Messages from a background load are buffered
+     */
+    void message(MessageLevel level, const std::string &msg);
+
+private:
+    enum class LoadState { Unloaded, Loading, Loaded, Failed };
+
+    bool load();
+
+    void flushMessages();
+
+private:
+    dmgr::IDebugMgr                                     *m_dmgr;
+    std::string                                         m_name;
+    std::string                                         m_pssfiles;
+    arl::dm::IContextUP                                 m_ctxt;
+    LoadState                                           m_state;
+    bool                                                m_async;
+    // Written by the load thread; read once it is joined
+    bool                                                m_load_ok;
+    std::thread                                         m_load_t;
+    std::mutex                                          m_load_mutex;
+    std::mutex                                          m_elab_mutex;
+    std::mutex                                          m_msg_mutex;
+    std::vector<std::pair<MessageLevel,std::string>>    m_msgs;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,130 @@
+/*
+ * NativeBackend.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "zsp/sv/FactoryExt.h"
+#include "Actor.h"
+#include "NativeBackend.h"
+#include "NativeFuncCall.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+NativeBackend::NativeBackend() : m_claimed(false), m_actor(0) {
+
+}
+
+NativeBackend::~NativeBackend() {
+
+}
+
+void NativeBackend::addFuncHandler(
+        const std::string           &name,
+        const FuncHandler           &handler) {
+    m_handler_m[name] = handler;
+    m_func_m.clear();
+}
+
+void NativeBackend::setDefaultFuncHandler(const FuncHandler &handler) {
+    m_default = handler;
+    m_func_m.clear();
+}
+
+void NativeBackend::callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) {
+    m_actor->callIssued(thread, func_t);
+
+    const FuncHandler *handler = findHandler(func_t);
+
+    // The call object lives in the call's parameter pool until the call
+    // completes
+    Arena &pool = m_actor->callParams(thread);
+    NativeFuncCall *call = pool.mk<NativeFuncCall>(
+        m_actor, 
+        thread, 
+        func_t, 
+        pool.mkArray<vsc::dm::ValRef>(params.size(), params.data()),
+        params.size());
+
+    if (!handler) {
+        // Complete the call, so the actor doesn't wait on it forever. The
+        // call object is not used once completed
+        zsp_sv_getFactory()->emitMessage(
+            MessageLevel::Error,
+            "No handler registered for function " + func_t->name()
+            + "; completing the call with a zero result");
+        if (call->hasResult()) {
+            call->setIntResult(0);
+        } else {
+            call->setVoidResult();
+        }
+        return;
+    }
+
+    (*handler)(call);
+}
+
+bool NativeBackend::claim() {
+    return !m_claimed.exchange(true);
+}
+
+void NativeBackend::enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_actor->actionStart(thread, action_t, action_v);
+}
+
+void NativeBackend::leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_actor->actionComplete(thread, action_t, action_v);
+}
+
+void NativeBackend::emitMessage(const std::string &msg) {
+    zsp_sv_getFactory()->emitMessage(MessageLevel::Info, msg);
+}
+
+const FuncHandler *NativeBackend::findHandler(arl::dm::IDataTypeFunction *func_t) {
+    std::unordered_map<arl::dm::IDataTypeFunction *, const FuncHandler *>::const_iterator it;
+
+    if ((it=m_func_m.find(func_t)) != m_func_m.end()) {
+        return it->second;
+    }
+
+    const FuncHandler *ret = 0;
+    std::map<std::string, FuncHandler>::const_iterator h_it = 
+        m_handler_m.find(func_t->name());
+    if (h_it != m_handler_m.end()) {
+        ret = &h_it->second;
+    } else if (m_default) {
+        ret = &m_default;
+    }
+    m_func_m.insert({func_t, ret});
+
+    return ret;
+}
+
+}
+}
@@ -0,0 +1,101 @@
+/**
+ * NativeBackend.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include "zsp/arl/eval/impl/EvalBackendBase.h"
+#include "zsp/sv/IBackend.h"
+
+namespace zsp {
+namespace sv {
+
+class Actor;
+
+class NativeBackend;
+using NativeBackendUP=std::unique_ptr<NativeBackend>;
+class NativeBackend : 
+    public virtual IBackend,
+    public virtual arl::eval::EvalBackendBase {
+public:
+    NativeBackend();
+
+    virtual ~NativeBackend();
+
+    virtual void addFuncHandler(
+        const std::string           &name,
+        const FuncHandler           &handler) override;
+
+    virtual void setDefaultFuncHandler(const FuncHandler &handler) override;
+
+    virtual void callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) override;
+
+    virtual void enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void emitMessage(const std::string &msg) override;
+
+    /**
+     * Reserves the backend for an actor being created. A backend serves
+     * a single actor, so this fails if it was already claimed
+     */
+    bool claim();
+
+    /**
+     * Releases a claim when creating the actor failed
+     */
+    void release() {
+        m_claimed = false;
+    }
+
+    void setActor(Actor *actor) {
+        m_actor = actor;
+    }
+
+private:
+    const FuncHandler *findHandler(arl::dm::IDataTypeFunction *func_t);
+
+private:
+    std::atomic<bool>                                       m_claimed;
+    Actor                                                   *m_actor;
+    std::map<std::string, FuncHandler>                      m_handler_m;
+    FuncHandler                                             m_default;
+    // Resolved handler per function type. Cleared when handlers change
+    std::unordered_map<arl::dm::IDataTypeFunction *, const FuncHandler *> m_func_m;
+
+};
+
+}
+}
+
+
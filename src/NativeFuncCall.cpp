@@ -0,0 +1,84 @@
+/*
+ * NativeFuncCall.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "vsc/dm/IDataTypeInt.h"
+#include "Actor.h"
+#include "NativeFuncCall.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+NativeFuncCall::NativeFuncCall(
+        Actor                               *actor,
+        arl::eval::IEvalThread              *thread,
+        arl::dm::IDataTypeFunction          *func_t,
+        vsc::dm::ValRef                     *params,
+        int32_t                             n_params) :
+            m_actor(actor), m_thread(thread), m_func_t(func_t),
+            m_params(params), m_n_params(n_params) {
+
+}
+
+NativeFuncCall::~NativeFuncCall() {
+
+}
+
+bool NativeFuncCall::isTarget() const {
+    return !m_func_t->hasFlags(arl::dm::DataTypeFunctionFlags::Solve);
+}
+
+uint64_t NativeFuncCall::getParamU(int32_t idx) const {
+    vsc::dm::ValRefInt val(param(idx));
+    return val.get_val_u();
+}
+
+int64_t NativeFuncCall::getParamS(int32_t idx) const {
+    vsc::dm::ValRefInt val(param(idx));
+    return val.get_val_s();
+}
+
+uint64_t NativeFuncCall::getParamAddr(int32_t idx) const {
+    return m_thread->getAddrHandleValue(param(idx)).get_val_u();
+}
+
+// Once applied, the result releases the call's parameter pool, destroying
+// this object, so the call is completed from copies of its state
+void NativeFuncCall::setVoidResult() {
+    Actor *actor = m_actor;
+    arl::eval::IEvalThread *thread = m_thread;
+
+    actor->setVoidResult(thread);
+}
+
+void NativeFuncCall::setIntResult(int64_t value) {
+    Actor *actor = m_actor;
+    arl::eval::IEvalThread *thread = m_thread;
+    vsc::dm::IDataTypeInt *ret_t = 
+        dynamic_cast<vsc::dm::IDataTypeInt *>(m_func_t->getReturnType());
+    bool is_signed = (ret_t)?ret_t->is_signed():true;
+    int32_t width = (ret_t)?ret_t->width():64;
+
+    actor->setIntResult(thread, value, is_signed, width);
+}
+
+}
+}
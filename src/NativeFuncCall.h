@@ -0,0 +1,87 @@
+/**
+ * NativeFuncCall.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdexcept>
+#include "zsp/arl/dm/IDataTypeFunction.h"
+#include "zsp/arl/eval/IEvalThread.h"
+#include "zsp/sv/IFuncCall.h"
+
+namespace zsp {
+namespace sv {
+
+class Actor;
+
+class NativeFuncCall : public virtual IFuncCall {
+public:
+    NativeFuncCall(
+        Actor                               *actor,
+        arl::eval::IEvalThread              *thread,
+        arl::dm::IDataTypeFunction          *func_t,
+        vsc::dm::ValRef                     *params,
+        int32_t                             n_params);
+
+    virtual ~NativeFuncCall();
+
+    virtual const std::string &name() const override {
+        return m_func_t->name();
+    }
+
+    virtual bool isTarget() const override;
+
+    virtual bool hasResult() const override {
+        return m_func_t->getReturnType() != 0;
+    }
+
+    virtual int32_t numParams() const override {
+        return m_n_params;
+    }
+
+    virtual uint64_t getParamU(int32_t idx) const override;
+
+    virtual int64_t getParamS(int32_t idx) const override;
+
+    virtual uint64_t getParamAddr(int32_t idx) const override;
+
+    virtual void setVoidResult() override;
+
+    virtual void setIntResult(int64_t value) override;
+
+private:
+    const vsc::dm::ValRef &param(int32_t idx) const {
+        if (idx < 0 || idx >= m_n_params) {
+            throw std::out_of_range("NativeFuncCall parameter index");
+        }
+        return m_params[idx];
+    }
+
+private:
+    Actor                                   *m_actor;
+    arl::eval::IEvalThread                  *m_thread;
+    arl::dm::IDataTypeFunction              *m_func_t;
+    vsc::dm::ValRef                         *m_params;
+    int32_t                                 m_n_params;
+
+};
+
+}
+}
+
+
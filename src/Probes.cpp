@@ -0,0 +1,32 @@
+/*
+ * Probes.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "Probes.h"
+
+#ifdef ZUSPEC_SV_USDT
+// Tracers locate the semaphores through the probe notes, and increment
+// them while attached
+#define ZSP_SV_PROBE_SEMAPHORE_DEF(name) \
+    volatile unsigned short ZSP_SV_PROBE_SEMAPHORE(name) \
+        __attribute__((section(".probes"))) = 0;
+extern "C" {
+ZSP_SV_PROBE_SEMAPHORES(ZSP_SV_PROBE_SEMAPHORE_DEF)
+}
+#endif
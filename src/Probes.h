@@ -0,0 +1,71 @@
+/**
+ * Probes.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ *
+ * USDT static tracepoints (provider 'zsp_sv'). Each probe compiles to a
+ * nop guarded by a semaphore that tracers (perf, bpftrace) increment when
+ * they attach, so probe arguments are only evaluated while the probe is in
+ * use. List them with: bpftrace -l 'usdt:<path>/libzsp-sv.so:zsp_sv:*'
+ */
+#pragma once
+
+#ifdef ZUSPEC_SV_USDT
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define ZSP_SV_PROBE_SEMAPHORE(name) zsp_sv_ ## name ## _semaphore
+
+#define ZSP_SV_PROBE_ENABLED(name) \
+    __builtin_expect(ZSP_SV_PROBE_SEMAPHORE(name) != 0, 0)
+
+// Every probe needs a semaphore, defined in Probes.cpp
+#define ZSP_SV_PROBE_SEMAPHORES(X) \
+    X(actor_eval_enter) \
+    X(actor_eval_exit) \
+    X(call_func_req) \
+    X(load_phase_enter) \
+    X(load_phase_exit) \
+    X(thread_set_int_result) \
+    X(thread_set_void_result)
+
+#define ZSP_SV_PROBE_SEMAPHORE_DECL(name) \
+    extern "C" volatile unsigned short ZSP_SV_PROBE_SEMAPHORE(name) \
+        __attribute__((visibility("hidden")));
+ZSP_SV_PROBE_SEMAPHORES(ZSP_SV_PROBE_SEMAPHORE_DECL)
+
+#define ZSP_SV_PROBE1(name, a1) \
+    do { if (ZSP_SV_PROBE_ENABLED(name)) { \
+        DTRACE_PROBE1(zsp_sv, name, a1); } } while (0)
+#define ZSP_SV_PROBE2(name, a1, a2) \
+    do { if (ZSP_SV_PROBE_ENABLED(name)) { \
+        DTRACE_PROBE2(zsp_sv, name, a1, a2); } } while (0)
+#define ZSP_SV_PROBE3(name, a1, a2, a3) \
+    do { if (ZSP_SV_PROBE_ENABLED(name)) { \
+        DTRACE_PROBE3(zsp_sv, name, a1, a2, a3); } } while (0)
+#define ZSP_SV_PROBE4(name, a1, a2, a3, a4) \
+    do { if (ZSP_SV_PROBE_ENABLED(name)) { \
+        DTRACE_PROBE4(zsp_sv, name, a1, a2, a3, a4); } } while (0)
+#else
+#define ZSP_SV_PROBE_ENABLED(name) 0
+#define ZSP_SV_PROBE1(name, a1)
+#define ZSP_SV_PROBE2(name, a1, a2)
+#define ZSP_SV_PROBE3(name, a1, a2, a3)
+#define ZSP_SV_PROBE4(name, a1, a2, a3, a4)
+#endif
+
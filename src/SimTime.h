@@ -0,0 +1,52 @@
+/**
+ * SimTime.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+namespace zsp {
+namespace sv {
+
+/**
+ * Current simulation time, as last passed in by the simulator 
+ * (zuspec_setTime). Units are those of the caller; the SV package passes
+ * $time. Read by the evaluating threads to stamp recorded events
+ */
+class SimTime {
+public:
+
+    static uint64_t get() {
+        return m_time.load(std::memory_order_relaxed);
+    }
+
+    static void set(uint64_t time) {
+        m_time.store(time, std::memory_order_relaxed);
+    }
+
+private:
+    static std::atomic<uint64_t>        m_time;
+
+};
+
+}
+}
+
+
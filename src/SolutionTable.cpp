@@ -0,0 +1,166 @@
+/*
+ * SolutionTable.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "vsc/dm/IModelFieldRef.h"
+#include "SolutionTable.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+SolutionTable::SolutionTable(uint32_t max_size, uint32_t saturate) :
+    m_max_size(max_size), m_saturate(saturate) {
+
+}
+
+SolutionTable::~SolutionTable() {
+
+}
+
+bool SolutionTable::sample(
+        vsc::solvers::IRandState                    *randstate,
+        const std::vector<vsc::dm::IModelField *>   &fields,
+        int32_t                                     flags) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!collect(fields, flags)) {
+        return false;
+    }
+
+    std::map<std::vector<uint64_t>, Entry>::const_iterator it = m_entries.find(m_inputs);
+    if (it == m_entries.end() || !it->second.complete) {
+        return false;
+    }
+
+    const Entry &entry = it->second;
+    if (entry.n_vars != m_vars.size()) {
+        return false;
+    }
+
+    // Occasionally solve anyway, in case learning missed a solution
+    if (!(randstate->rand_ui64() % RecheckPeriod)) {
+        return false;
+    }
+    uint64_t n_rows = entry.rows.size() / entry.n_vars;
+    const uint64_t *row = &entry.rows[(randstate->rand_ui64() % n_rows) * entry.n_vars];
+    for (uint32_t i=0; i<entry.n_vars; i++) {
+        vsc::dm::IModelVal *val = m_vars.at(i)->val();
+        val->set_val_u(row[i], val->bits());
+    }
+
+    return true;
+}
+
+void SolutionTable::record(
+        const std::vector<vsc::dm::IModelField *>   &fields,
+        int32_t                                     flags) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!collect(fields, flags) || !m_vars.size()) {
+        return;
+    }
+
+    Entry &entry = m_entries[m_inputs];
+    if (entry.overflow) {
+        return;
+    }
+    entry.n_vars = m_vars.size();
+
+    m_row.clear();
+    for (std::vector<vsc::dm::IModelField *>::const_iterator
+        it=m_vars.begin();
+        it!=m_vars.end(); it++) {
+        m_row.push_back((*it)->val()->val_u());
+    }
+
+    // A complete table is sampled from while it grows, and stays so
+    if (entry.seen.insert(m_row).second) {
+        entry.rows.insert(entry.rows.end(), m_row.begin(), m_row.end());
+        entry.misses = 0;
+        if (entry.seen.size() > m_max_size) {
+            // Too large to tabulate. Release the storage
+            entry.overflow = true;
+            entry.complete = false;
+            entry.rows = std::vector<uint64_t>();
+            entry.seen.clear();
+        }
+    } else if (!entry.complete
+            && ++entry.misses >= m_saturate 
+            && entry.misses >= 2*entry.seen.size()) {
+        // No new solution for a while; assume all have been seen
+        entry.complete = true;
+    }
+}
+
+void SolutionTable::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+}
+
+bool SolutionTable::collect(
+        const std::vector<vsc::dm::IModelField *>   &fields,
+        int32_t                                     flags) {
+    m_vars.clear();
+    m_inputs.clear();
+    m_inputs.push_back(flags);
+
+    for (std::vector<vsc::dm::IModelField *>::const_iterator
+        it=fields.begin();
+        it!=fields.end(); it++) {
+        if (!collect(*it)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SolutionTable::collect(vsc::dm::IModelField *field) {
+    // State reached through a reference isn't part of the signature
+    if (dynamic_cast<vsc::dm::IModelFieldRef *>(field)) {
+        return false;
+    }
+
+    if (field->getFields().size()) {
+        for (std::vector<vsc::dm::IModelFieldUP>::const_iterator
+            it=field->getFields().begin();
+            it!=field->getFields().end(); it++) {
+            if (!collect(it->get())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    vsc::dm::IModelVal *val = field->val();
+    if (!val || val->bits() > 64) {
+        return false;
+    }
+
+    if (field->isFlagSet(vsc::dm::ModelFieldFlag::DeclRand)
+        || field->isFlagSet(vsc::dm::ModelFieldFlag::UsedRand)) {
+        m_vars.push_back(field);
+    } else {
+        m_inputs.push_back(val->val_u());
+    }
+    return true;
+}
+
+}
+}
+
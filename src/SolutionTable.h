@@ -0,0 +1,132 @@
+/**
+ * SolutionTable.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "vsc/dm/IModelField.h"
+#include "vsc/solvers/IRandState.h"
+
+namespace zsp {
+namespace sv {
+
+class SolutionTable;
+using SolutionTableUP=std::unique_ptr<SolutionTable>;
+
+/**
+ * Table of the legal solutions of a type with a small, finite solution
+ * space. The solver does not expose enumeration, so the table is learned:
+ * distinct solutions are collected from normal solves until no new one
+ * has been seen for a number of consecutive solves. From then on, solves
+ * sample uniformly from the table. Completion is a heuristic, so one in
+ * RecheckPeriod solves of a complete table still uses the solver, and a
+ * legal solution missed while learning is added when it turns up. Until
+ * then it is not generated. Tables are kept per signature of the non-random
+ * inputs, since those change the solution space. Signatures whose space 
+ * exceeds the size bound always use the solver. The signature only covers
+ * the solved fields themselves. Solves whose fields hold a reference (eg
+ * a comp, pool or resource handle) always use the solver, since their 
+ * constraints may read state through it, and the reference itself may be
+ * part of the solution. The caller must not use a table for solves with
+ * additional (eg inline) constraints, which the signature does not 
+ * capture.
+ * 
+ * A table may be shared by actors on different threads, pooling what 
+ * they learn; access is serialized. Since references are never 
+ * tabulated, a signature has the same meaning in every actor. Whether a
+ * solve is answered from a shared table, and so how it consumes the random state, then depends on
+ * the progress of the other actors: results are no longer reproducible
+ * from an actor's seed alone.
+ */
+class SolutionTable {
+public:
+    // Once a table is complete, one in this many solves uses the solver
+    static const uint32_t   RecheckPeriod = 64;
+
+    SolutionTable(uint32_t max_size, uint32_t saturate);
+
+    virtual ~SolutionTable();
+
+    /**
+     * Applies a random solution from the table, if the table for the
+     * current inputs is complete. Returns false if the solver must be 
+     * used: while learning, and for rechecks of a complete table
+     */
+    bool sample(
+        vsc::solvers::IRandState                    *randstate,
+        const std::vector<vsc::dm::IModelField *>   &fields,
+        int32_t                                     flags);
+
+    /**
+     * Records the solution just produced by the solver. Complete tables
+     * still take solutions not seen before
+     */
+    void record(
+        const std::vector<vsc::dm::IModelField *>   &fields,
+        int32_t                                     flags);
+
+    /**
+     * Discards everything learned
+     */
+    void clear();
+
+private:
+    struct Entry {
+        Entry() : n_vars(0), misses(0), complete(false), overflow(false) { }
+
+        uint32_t                                n_vars;
+        // Row-major solution values, n_vars per row
+        std::vector<uint64_t>                   rows;
+        std::set<std::vector<uint64_t>>         seen;
+        uint32_t                                misses;
+        bool                                    complete;
+        bool                                    overflow;
+    };
+
+    /**
+     * Splits the leaf fields into random variables and inputs. Returns 
+     * false if a field is a reference or too wide to tabulate
+     */
+    bool collect(
+        const std::vector<vsc::dm::IModelField *>   &fields,
+        int32_t                                     flags);
+
+    bool collect(vsc::dm::IModelField *field);
+
+private:
+    std::mutex                                      m_mutex;
+    uint32_t                                        m_max_size;
+    uint32_t                                        m_saturate;
+    std::map<std::vector<uint64_t>, Entry>          m_entries;
+    // Scratch state for the solve being handled
+    std::vector<vsc::dm::IModelField *>             m_vars;
+    std::vector<uint64_t>                           m_inputs;
+    std::vector<uint64_t>                           m_row;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,184 @@
+/*
+ * SolverFactoryProxy.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "vsc/dm/IDataTypeStruct.h"
+#include "CompoundSolverProxy.h"
+#include "SolverFactoryProxy.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+SolverFactoryProxy::SolverFactoryProxy(
+    vsc::solvers::IFactory *target) : m_target(target), 
+        m_type_stats_valid(false), m_cov_bias(0), m_cov_bias_k(0) {
+
+}
+
+SolverFactoryProxy::~SolverFactoryProxy() {
+
+}
+
+void SolverFactoryProxy::init(dmgr::IDebugMgr *dmgr) {
+    m_target->init(dmgr);
+}
+
+dmgr::IDebugMgr *SolverFactoryProxy::getDebugMgr() {
+    return m_target->getDebugMgr();
+}
+
+vsc::solvers::ICompoundSolver *SolverFactoryProxy::mkCompoundSolver(
+        vsc::dm::IContext           *ctxt) {
+    return new CompoundSolverProxy(
+        this,
+        m_target->mkCompoundSolver(ctxt));
+}
+
+void SolverFactoryProxy::recordSolve(
+        vsc::dm::IDataType          *type,
+        uint64_t                    ns,
+        uint64_t                    vars,
+        bool                        ok,
+        bool                        hit) {
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+
+    m_stats.count++;
+    m_stats.time_ns += ns;
+    m_stats.vars += vars;
+    if (ns > m_stats.max_time_ns) {
+        m_stats.max_time_ns = ns;
+    }
+    if (!ok) {
+        m_stats.failures++;
+    }
+    if (hit) {
+        m_stats.table_hits++;
+    }
+
+    SolveStats &type_stats = getTypeStats(type);
+    type_stats.count++;
+    type_stats.time_ns += ns;
+    type_stats.vars += vars;
+    if (ns > type_stats.max_time_ns) {
+        type_stats.max_time_ns = ns;
+    }
+    if (type_stats.last_failed) {
+        type_stats.retries++;
+    }
+    if (!ok) {
+        type_stats.failures++;
+    }
+    type_stats.last_failed = !ok;
+    if (hit) {
+        type_stats.table_hits++;
+    }
+    m_type_stats_valid = false;
+}
+
+SolveStats SolverFactoryProxy::getStats() const {
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    return m_stats;
+}
+
+std::map<std::string, SolveStats> SolverFactoryProxy::getTypeStats() const {
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    return m_type_stats;
+}
+
+const std::vector<std::pair<std::string, SolveStats>> &SolverFactoryProxy::getTypeStatsList() {
+    // Statistics updated while the list is rebuilt invalidate it again
+    if (!m_type_stats_valid.exchange(true)) {
+        std::map<std::string, SolveStats> stats = getTypeStats();
+        m_type_stats_l.assign(stats.begin(), stats.end());
+    }
+    return m_type_stats_l;
+}
+
+SolveStats &SolverFactoryProxy::getTypeStats(vsc::dm::IDataType *type) {
+    std::unordered_map<vsc::dm::IDataType *, SolveStats *>::const_iterator it;
+
+    if ((it=m_type_m.find(type)) != m_type_m.end()) {
+        return *it->second;
+    }
+
+    vsc::dm::IDataTypeStruct *type_s = dynamic_cast<vsc::dm::IDataTypeStruct *>(type);
+    SolveStats *stats = &m_type_stats[(type_s)?type_s->name():"<anonymous>"];
+    m_type_m.insert({type, stats});
+
+    return *stats;
+}
+
+void SolverFactoryProxy::addSolutionTable(
+        const std::string           &type,
+        uint32_t                    max_size,
+        uint32_t                    saturate) {
+    m_tables.push_back(SolutionTableUP(new SolutionTable(max_size, saturate)));
+    addSolutionTable(type, m_tables.back().get());
+}
+
+void SolverFactoryProxy::addSolutionTable(
+        const std::string           &type,
+        SolutionTable               *table) {
+    m_table_s_m[type] = table;
+    m_table_m.clear();
+}
+
+void SolverFactoryProxy::clearSolutionTables() {
+    for (std::vector<SolutionTableUP>::const_iterator
+        it=m_tables.begin();
+        it!=m_tables.end(); it++) {
+        (*it)->clear();
+    }
+}
+
+SolutionTable *SolverFactoryProxy::getSolutionTable(vsc::dm::IDataType *type) {
+    std::unordered_map<vsc::dm::IDataType *, SolutionTable *>::const_iterator it;
+
+    if (!m_table_s_m.size()) {
+        return 0;
+    }
+
+    if ((it=m_table_m.find(type)) != m_table_m.end()) {
+        return it->second;
+    }
+
+    SolutionTable *ret = 0;
+    vsc::dm::IDataTypeStruct *type_s = dynamic_cast<vsc::dm::IDataTypeStruct *>(type);
+    if (type_s) {
+        std::map<std::string, SolutionTable *>::const_iterator t_it = 
+            m_table_s_m.find(type_s->name());
+        if (t_it != m_table_s_m.end()) {
+            ret = t_it->second;
+        }
+    }
+    m_table_m.insert({type, ret});
+
+    return ret;
+}
+
+vsc::solvers::IRandState *SolverFactoryProxy::mkRandState(
+        const std::string           &seed) {
+    return m_target->mkRandState(seed);
+}
+
+}
+}
+
@@ -0,0 +1,177 @@
+/**
+ * SolverFactoryProxy.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "vsc/solvers/IFactory.h"
+#include "ActorCoverage.h"
+#include "SolutionTable.h"
+
+namespace zsp {
+namespace sv {
+
+
+struct SolveStats {
+    SolveStats() : count(0), failures(0), retries(0), table_hits(0),
+        time_ns(0), max_time_ns(0), vars(0), last_failed(false) { }
+
+    void add(const SolveStats &o) {
+        count += o.count;
+        failures += o.failures;
+        retries += o.retries;
+        table_hits += o.table_hits;
+        time_ns += o.time_ns;
+        max_time_ns = (o.max_time_ns > max_time_ns)?o.max_time_ns:max_time_ns;
+        vars += o.vars;
+    }
+
+    uint64_t                    count;
+    uint64_t                    failures;
+    // Solves that immediately follow a failed solve of the same type
+    uint64_t                    retries;
+    // Solves answered from a solution table
+    uint64_t                    table_hits;
+    uint64_t                    time_ns;
+    uint64_t                    max_time_ns;
+    // Total variables over all solves
+    uint64_t                    vars;
+    bool                        last_failed;
+};
+
+/**
+ * Wraps the solver factory handed to an actor's evaluation context, 
+ * so solves performed on the actor's behalf can be observed
+ */
+class SolverFactoryProxy : public virtual vsc::solvers::IFactory {
+public:
+    SolverFactoryProxy(vsc::solvers::IFactory *target);
+
+    virtual ~SolverFactoryProxy();
+
+    virtual void init(dmgr::IDebugMgr *dmgr) override;
+
+    virtual dmgr::IDebugMgr *getDebugMgr() override;
+
+    virtual vsc::solvers::ICompoundSolver *mkCompoundSolver(
+        vsc::dm::IContext           *ctxt) override;
+
+    virtual vsc::solvers::IRandState *mkRandState(
+        const std::string           &seed) override;
+
+    /**
+     * Records a solve of the given root-field type
+     */
+    void recordSolve(
+        vsc::dm::IDataType          *type,
+        uint64_t                    ns,
+        uint64_t                    vars,
+        bool                        ok,
+        bool                        hit);
+
+    SolveStats getStats() const;
+
+    /**
+     * Per-type statistics, keyed by type name
+     */
+    std::map<std::string, SolveStats> getTypeStats() const;
+
+    /**
+     * Per-type statistics, in name order. The list is rebuilt only when 
+     * the statistics have changed, so it can be indexed cheaply
+     */
+    const std::vector<std::pair<std::string, SolveStats>> &getTypeStatsList();
+
+    /**
+     * Enables a solution table for solves of the named type. Must be 
+     * called before that type is first solved
+     */
+    void addSolutionTable(
+        const std::string           &type,
+        uint32_t                    max_size,
+        uint32_t                    saturate);
+
+    /**
+     * Uses a solution table owned elsewhere (eg shared between actors)
+     * for solves of the named type
+     */
+    void addSolutionTable(
+        const std::string           &type,
+        SolutionTable               *table);
+
+    /**
+     * Discards what the tables owned by this factory have learned. Tables
+     * owned elsewhere are not affected
+     */
+    void clearSolutionTables();
+
+    /**
+     * Returns the solution table for a type, or null
+     */
+    SolutionTable *getSolutionTable(vsc::dm::IDataType *type);
+
+    /**
+     * Biases solves of covered action types toward unhit bins by taking
+     * the best-scoring of 'k' solutions
+     */
+    void setCoverageBias(ActorCoverage *cov, uint32_t k) {
+        m_cov_bias = cov;
+        m_cov_bias_k = k;
+    }
+
+    ActorCoverage *getCoverageBias() const {
+        return m_cov_bias;
+    }
+
+    uint32_t getCoverageBiasK() const {
+        return m_cov_bias_k;
+    }
+
+private:
+    SolveStats &getTypeStats(vsc::dm::IDataType *type);
+
+private:
+    vsc::solvers::IFactory                                      *m_target;
+    // Guards the statistics. With setAsync, solves run on the worker 
+    // while the simulator thread reads them
+    mutable std::mutex                                          m_stats_mutex;
+    SolveStats                                                  m_stats;
+    std::map<std::string, SolveStats>                           m_type_stats;
+    // Caches the per-type entry, avoiding a name lookup per solve
+    std::unordered_map<vsc::dm::IDataType *, SolveStats *>      m_type_m;
+    std::vector<std::pair<std::string, SolveStats>>             m_type_stats_l;
+    std::atomic<bool>                                           m_type_stats_valid;
+    std::vector<SolutionTableUP>                                m_tables;
+    std::map<std::string, SolutionTable *>                      m_table_s_m;
+    std::unordered_map<vsc::dm::IDataType *, SolutionTable *>   m_table_m;
+    ActorCoverage                                               *m_cov_bias;
+    uint32_t                                                    m_cov_bias_k;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,182 @@
+/*
+ * SparseMem.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <algorithm>
+#include <string.h>
+#include "SparseMem.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+SparseMem::SparseMem() : n_served(0), n_checked(0), n_mismatch(0),
+        m_last_pn(0), m_last(0) {
+
+}
+
+SparseMem::~SparseMem() {
+
+}
+
+bool SparseMem::read(uint64_t addr, uint8_t *data, uint32_t n) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool valid = true;
+
+    while (n) {
+        uint32_t off = (addr & (PAGE_SIZE-1));
+        uint32_t sz = std::min(n, PAGE_SIZE-off);
+        Page *page = getPage(addr >> PAGE_BITS, false);
+
+        if (page) {
+            memcpy(data, &page->data[off], sz);
+            for (uint32_t i=off; i<off+sz; i++) {
+                valid &= ((page->valid[i/64] >> (i%64)) & 1);
+            }
+        } else {
+            memset(data, 0, sz);
+            valid = false;
+        }
+
+        addr += sz;
+        data += sz;
+        n -= sz;
+    }
+
+    return valid;
+}
+
+void SparseMem::write(uint64_t addr, const uint8_t *data, uint32_t n) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    while (n) {
+        uint32_t off = (addr & (PAGE_SIZE-1));
+        uint32_t sz = std::min(n, PAGE_SIZE-off);
+        Page *page = getPage(addr >> PAGE_BITS, true);
+
+        memcpy(&page->data[off], data, sz);
+        for (uint32_t i=off; i<off+sz; i++) {
+            page->valid[i/64] |= (1ULL << (i%64));
+        }
+
+        addr += sz;
+        data += sz;
+        n -= sz;
+    }
+}
+
+bool SparseMem::readInt(uint64_t addr, uint32_t size, uint64_t &val) {
+    uint8_t data[8];
+    bool ret = read(addr, data, size);
+
+    val = 0;
+    for (uint32_t i=0; i<size; i++) {
+        val |= (uint64_t(data[i]) << (8*i));
+    }
+
+    return ret;
+}
+
+void SparseMem::writeInt(uint64_t addr, uint32_t size, uint64_t val) {
+    uint8_t data[8];
+
+    for (uint32_t i=0; i<size; i++) {
+        data[i] = (val >> (8*i));
+    }
+
+    write(addr, data, size);
+}
+
+std::vector<uint64_t> SparseMem::pages() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<uint64_t> ret;
+
+    for (std::unordered_map<uint64_t, PageUP>::const_iterator
+        it=m_page_m.begin();
+        it!=m_page_m.end(); it++) {
+        ret.push_back(it->first << PAGE_BITS);
+    }
+    std::sort(ret.begin(), ret.end());
+
+    return ret;
+}
+
+uint32_t SparseMem::pages(uint64_t from, uint64_t *addrs, uint32_t max) const {
+    uint64_t pn_min = (from >> PAGE_BITS) + ((from & (PAGE_SIZE-1))?1:0);
+    std::vector<uint64_t> pns;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::unordered_map<uint64_t, PageUP>::const_iterator
+            it=m_page_m.begin();
+            it!=m_page_m.end(); it++) {
+            if (it->first >= pn_min) {
+                pns.push_back(it->first);
+            }
+        }
+    }
+
+    // Only the first 'max' need to be ordered
+    if (pns.size() > max) {
+        std::nth_element(pns.begin(), pns.begin()+max, pns.end());
+        pns.resize(max);
+    }
+    std::sort(pns.begin(), pns.end());
+
+    for (uint32_t i=0; i<pns.size(); i++) {
+        addrs[i] = pns.at(i) << PAGE_BITS;
+    }
+
+    return pns.size();
+}
+
+uint64_t SparseMem::numPages() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_page_m.size();
+}
+
+void SparseMem::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_page_m.clear();
+    m_last = 0;
+}
+
+SparseMem::Page *SparseMem::getPage(uint64_t pn, bool create) {
+    if (m_last && m_last_pn == pn) {
+        return m_last;
+    }
+
+    std::unordered_map<uint64_t, PageUP>::iterator it;
+    if ((it=m_page_m.find(pn)) != m_page_m.end()) {
+        m_last = it->second.get();
+    } else if (create) {
+        Page *page = new Page();
+        m_page_m.insert({pn, PageUP(page)});
+        m_last = page;
+    } else {
+        return 0;
+    }
+    m_last_pn = pn;
+
+    return m_last;
+}
+
+}
+}
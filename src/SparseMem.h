@@ -0,0 +1,110 @@
+/**
+ * SparseMem.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace zsp {
+namespace sv {
+
+class SparseMem;
+using SparseMemUP=std::unique_ptr<SparseMem>;
+
+/**
+ * Byte-addressed sparse memory backed by a table of 4KB pages allocated
+ * on first write. Each page tracks which of its bytes have been written,
+ * so reads can tell initialized data from unknown data. Accesses are 
+ * little-endian and may cross pages. Shared by all actors, so accesses
+ * are serialized.
+ */
+class SparseMem {
+public:
+    static const uint32_t PAGE_BITS = 12;
+    static const uint32_t PAGE_SIZE = (1U << PAGE_BITS);
+
+    SparseMem();
+
+    virtual ~SparseMem();
+
+    /**
+     * Reads 'n' bytes. Unwritten bytes read as 0. Returns true if all 
+     * bytes had been written
+     */
+    bool read(uint64_t addr, uint8_t *data, uint32_t n);
+
+    void write(uint64_t addr, const uint8_t *data, uint32_t n);
+
+    /**
+     * Reads a little-endian value of 'size' (1..8) bytes
+     */
+    bool readInt(uint64_t addr, uint32_t size, uint64_t &val);
+
+    void writeInt(uint64_t addr, uint32_t size, uint64_t val);
+
+    /**
+     * Returns the base addresses of allocated pages, in address order
+     */
+    std::vector<uint64_t> pages() const;
+
+    /**
+     * Copies to 'addrs' the base addresses of up to 'max' allocated 
+     * pages at or above 'from', in address order. Returns the number 
+     * copied. Walks the pages in chunks without holding state between
+     * calls
+     */
+    uint32_t pages(uint64_t from, uint64_t *addrs, uint32_t max) const;
+
+    uint64_t numPages() const;
+
+    void clear();
+
+    // Statistics, maintained by the actors' memory backends
+    std::atomic<uint64_t>                       n_served;
+    std::atomic<uint64_t>                       n_checked;
+    std::atomic<uint64_t>                       n_mismatch;
+
+private:
+    struct Page {
+        uint8_t                                 data[PAGE_SIZE];
+        // One bit per byte, set once written
+        uint64_t                                valid[PAGE_SIZE/64];
+    };
+    using PageUP=std::unique_ptr<Page>;
+
+    Page *getPage(uint64_t pn, bool create);
+
+private:
+    mutable std::mutex                          m_mutex;
+    std::unordered_map<uint64_t, PageUP>        m_page_m;
+    // Most-recently accessed page. Accesses tend to be local
+    uint64_t                                    m_last_pn;
+    Page                                        *m_last;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,179 @@
+/*
+ * SparseMemBackend.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "vsc/dm/IDataTypeInt.h"
+#include "Actor.h"
+#include "AsyncEval.h"
+#include "SparseMemBackend.h"
+#include "ZuspecSvDpiImp.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+SparseMemBackend::SparseMemBackend(
+        Actor                       *actor,
+        arl::eval::IEvalBackend     *target,
+        SparseMem                   *mem,
+        MemMode                     mode) :
+            m_actor(actor), m_target(target), m_mem(mem), m_mode(mode) {
+
+}
+
+SparseMemBackend::~SparseMemBackend() {
+
+}
+
+void SparseMemBackend::callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) {
+    const MemOp &op = getOp(func_t);
+
+    if (!op.size || params.size() < (op.is_write?2U:1U)) {
+        m_target->callFuncReq(thread, func_t, params);
+        return;
+    }
+
+    uint64_t addr = thread->getAddrHandleValue(params.at(0)).get_val_u();
+
+    if (op.is_write) {
+        vsc::dm::ValRefInt data(params.at(1));
+        m_mem->writeInt(addr, op.size, data.get_val_u());
+    }
+
+    if (m_mode == MemMode::Shadow) {
+        if (!op.is_write) {
+            m_reads[thread] = {addr, op.size};
+        }
+        m_target->callFuncReq(thread, func_t, params);
+        return;
+    }
+
+    // Completed here, through the actor so the journal sees the result
+    m_actor->callIssued(thread, func_t);
+    m_mem->n_served.fetch_add(1, std::memory_order_relaxed);
+    if (op.is_write) {
+        m_actor->applyVoidResult(thread);
+    } else {
+        uint64_t val;
+        m_mem->readInt(addr, op.size, val);
+        m_actor->applyIntResult(thread, val, false, op.width);
+    }
+}
+
+void SparseMemBackend::enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_target->enterAction(thread, action_t, action_v);
+}
+
+void SparseMemBackend::leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) {
+    m_target->leaveAction(thread, action_t, action_v);
+}
+
+void SparseMemBackend::emitMessage(const std::string &msg) {
+    m_target->emitMessage(msg);
+}
+
+void SparseMemBackend::intResult(arl::eval::IEvalThread *thread, uint64_t value) {
+    std::unordered_map<arl::eval::IEvalThread *, PendingRead>::iterator it;
+
+    if ((it=m_reads.find(thread)) == m_reads.end()) {
+        return;
+    }
+
+    uint64_t mask = (it->second.size == 8)?~0ULL:((1ULL << 8*it->second.size) - 1);
+    uint64_t expect;
+    value &= mask;
+
+    // Only data written through the memory is checked
+    if (m_mem->readInt(it->second.addr, it->second.size, expect)) {
+        m_mem->n_checked.fetch_add(1, std::memory_order_relaxed);
+        if (expect != value) {
+            char tmp[256];
+            m_mem->n_mismatch.fetch_add(1, std::memory_order_relaxed);
+            snprintf(tmp, sizeof(tmp),
+                "Memory mismatch: actor %d read%u @ 0x%llx returned 0x%llx, expected 0x%llx",
+                m_actor->id(), 8*it->second.size,
+                (unsigned long long)it->second.addr,
+                (unsigned long long)value,
+                (unsigned long long)expect);
+            // Async actors apply results on the worker thread, which 
+            // must not call into the simulator
+            if (m_actor->getAsync()) {
+                m_actor->getAsync()->postError(tmp);
+            } else {
+                zuspec_error(tmp);
+            }
+        }
+    }
+    m_mem->writeInt(it->second.addr, it->second.size, value);
+
+    m_reads.erase(it);
+}
+
+const SparseMemBackend::MemOp &SparseMemBackend::getOp(
+        arl::dm::IDataTypeFunction *func_t) {
+    std::unordered_map<arl::dm::IDataTypeFunction *, MemOp>::const_iterator it;
+
+    if ((it=m_op_m.find(func_t)) != m_op_m.end()) {
+        return it->second;
+    }
+
+    static const char *PREFIX = "addr_reg_pkg::";
+    const std::string &name = func_t->name();
+    MemOp op = {0, false, 0};
+    uint32_t bits = 0;
+
+    if (name.compare(0, strlen(PREFIX), PREFIX) == 0) {
+        std::string leaf = name.substr(strlen(PREFIX));
+        if (sscanf(leaf.c_str(), "read%u", &bits) == 1 
+            && leaf == "read" + std::to_string(bits)) {
+            op.is_write = false;
+        } else if (sscanf(leaf.c_str(), "write%u", &bits) == 1
+            && leaf == "write" + std::to_string(bits)) {
+            op.is_write = true;
+        }
+    }
+
+    if (bits == 8 || bits == 16 || bits == 32 || bits == 64) {
+        op.size = bits/8;
+        op.width = bits;
+        vsc::dm::IDataTypeInt *ret_t = 
+            dynamic_cast<vsc::dm::IDataTypeInt *>(func_t->getReturnType());
+        if (ret_t) {
+            op.width = ret_t->width();
+        }
+    }
+
+    return m_op_m.insert({func_t, op}).first->second;
+}
+
+}
+}
@@ -0,0 +1,112 @@
+/**
+ * SparseMemBackend.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include "zsp/arl/eval/impl/EvalBackendBase.h"
+#include "SparseMem.h"
+
+namespace zsp {
+namespace sv {
+
+class Actor;
+
+enum class MemMode {
+    // Memory accesses are answered by the sparse memory, without a call
+    // to the environment
+    Functional,
+    // Accesses go to the environment. Writes are mirrored in the sparse
+    // memory, and read results are checked against it
+    Shadow
+};
+
+class SparseMemBackend;
+using SparseMemBackendUP=std::unique_ptr<SparseMemBackend>;
+
+/**
+ * Interposes between an actor's evaluation context and its backend, and
+ * handles the addr_reg_pkg read/write functions (read8..read64, 
+ * write8..write64) with a SparseMem. Other calls are passed through.
+ */
+class SparseMemBackend : public virtual arl::eval::EvalBackendBase {
+public:
+    SparseMemBackend(
+        Actor                       *actor,
+        arl::eval::IEvalBackend     *target,
+        SparseMem                   *mem,
+        MemMode                     mode);
+
+    virtual ~SparseMemBackend();
+
+    virtual void callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) override;
+
+    virtual void enterAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void leaveAction(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeAction            *action_t,
+            const vsc::dm::ValRef               &action_v) override;
+
+    virtual void emitMessage(const std::string &msg) override;
+
+    /**
+     * Called with the result of each call. In shadow mode, results of 
+     * memory reads are checked against (and then stored in) the memory.
+     * Mismatches of async actors are reported when the actor dispatches
+     */
+    void intResult(arl::eval::IEvalThread *thread, uint64_t value);
+
+private:
+    struct MemOp {
+        // 0 for functions other than memory accesses
+        uint32_t                                size;
+        bool                                    is_write;
+        int32_t                                 width;
+    };
+
+    struct PendingRead {
+        uint64_t                                addr;
+        uint32_t                                size;
+    };
+
+    const MemOp &getOp(arl::dm::IDataTypeFunction *func_t);
+
+private:
+    Actor                                       *m_actor;
+    arl::eval::IEvalBackend                     *m_target;
+    SparseMem                                   *m_mem;
+    MemMode                                     m_mode;
+    std::unordered_map<arl::dm::IDataTypeFunction *, MemOp>     m_op_m;
+    // Shadow-mode reads awaiting their result
+    std::unordered_map<arl::eval::IEvalThread *, PendingRead>   m_reads;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,88 @@
+/*
+ * StatsShm.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <new>
+#include "StatsShm.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+StatsShm::StatsShm(
+    const std::string   &name,
+    ShmStatsBlock       *block) : m_name(name), m_mapped(block) {
+
+}
+
+StatsShm::~StatsShm() {
+    if (m_block == m_mapped) {
+        m_block = 0;
+    }
+    munmap(m_mapped, sizeof(ShmStatsBlock));
+    shm_unlink(m_name.c_str());
+}
+
+StatsShm *StatsShm::create(const std::string &name) {
+    int fd = shm_open(name.c_str(), O_CREAT|O_TRUNC|O_RDWR, 0644);
+
+    if (fd == -1) {
+        return 0;
+    }
+
+    if (ftruncate(fd, sizeof(ShmStatsBlock)) == -1) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return 0;
+    }
+
+    void *p = mmap(0, sizeof(ShmStatsBlock), 
+        PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (p == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return 0;
+    }
+
+    memset(p, 0, sizeof(ShmStatsBlock));
+    ShmStatsBlock *block = new (p) ShmStatsBlock();
+    block->pid = getpid();
+    block->version = ShmStatsBlock::VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    block->magic = ShmStatsBlock::MAGIC;
+
+    return new StatsShm(name, block);
+}
+
+void StatsShm::setActive(StatsShm *shm) {
+    m_block = (shm)?shm->m_mapped:0;
+}
+
+ShmStatsBlock *StatsShm::m_block = 0;
+
+}
+}
+
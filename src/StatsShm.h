@@ -0,0 +1,90 @@
+/**
+ * StatsShm.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+namespace zsp {
+namespace sv {
+
+/**
+ * Layout of the POSIX shared-memory statistics segment. Counters are
+ * 64-bit little-endian words written with relaxed atomics. Keep in sync
+ * with python/zsp_sv/stats.py
+ */
+struct ShmStatsBlock {
+    static const uint32_t MAGIC = 0x5350535a; // "ZSPS"
+    static const uint32_t VERSION = 1;
+
+    uint32_t                    magic;
+    uint32_t                    version;
+    uint64_t                    pid;
+    std::atomic<uint64_t>       actors;
+    std::atomic<uint64_t>       evals;
+    std::atomic<uint64_t>       eval_ns;
+    std::atomic<uint64_t>       actions_executed;
+    std::atomic<uint64_t>       calls_issued;
+    std::atomic<uint64_t>       calls_completed;
+    std::atomic<uint64_t>       solves;
+    std::atomic<uint64_t>       solve_ns;
+};
+
+class StatsShm;
+using StatsShmUP=std::unique_ptr<StatsShm>;
+class StatsShm {
+public:
+
+    virtual ~StatsShm();
+
+    /**
+     * Creates and maps the named segment. Returns null on failure
+     */
+    static StatsShm *create(const std::string &name);
+
+    const std::string &name() const {
+        return m_name;
+    }
+
+    /**
+     * Returns the active statistics block, or null when disabled
+     */
+    static ShmStatsBlock *block() {
+        return m_block;
+    }
+
+    static void setActive(StatsShm *shm);
+
+private:
+    StatsShm(const std::string &name, ShmStatsBlock *block);
+
+private:
+    static ShmStatsBlock        *m_block;
+    std::string                 m_name;
+    ShmStatsBlock               *m_mapped;
+
+};
+
+}
+}
+
+
@@ -0,0 +1,60 @@
+/*
+ * TaskFindActivityRepeat.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include "TaskFindActivityRepeat.h"
+
+
+namespace zsp {
+namespace sv {
+
+
+TaskFindActivityRepeat::TaskFindActivityRepeat() : m_found(false) {
+
+}
+
+TaskFindActivityRepeat::~TaskFindActivityRepeat() {
+
+}
+
+bool TaskFindActivityRepeat::find(arl::dm::IDataTypeAction *action_t) {
+    m_found = false;
+    m_visited.clear();
+    action_t->accept(m_this);
+    return m_found;
+}
+
+void TaskFindActivityRepeat::visitDataTypeAction(arl::dm::IDataTypeAction *t) {
+    if (!m_found && m_visited.insert(t).second) {
+        VisitorBase::visitDataTypeAction(t);
+    }
+}
+
+void TaskFindActivityRepeat::visitDataTypeActivityRepeatCount(
+        arl::dm::IDataTypeActivityRepeatCount *t) {
+    m_found = true;
+}
+
+void TaskFindActivityRepeat::visitDataTypeActivityRepeatWhile(
+        arl::dm::IDataTypeActivityRepeatWhile *t) {
+    m_found = true;
+}
+
+}
+}
@@ -0,0 +1,62 @@
+/**
+ * TaskFindActivityRepeat.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <set>
+#include "zsp/arl/dm/impl/VisitorBase.h"
+
+namespace zsp {
+namespace sv {
+
+
+/**
+ * Finds repeat (counted, while, or forever) activities in an action's
+ * activity, including those of the compound actions it traverses
+ */
+class TaskFindActivityRepeat : public virtual arl::dm::VisitorBase {
+public:
+    TaskFindActivityRepeat();
+
+    virtual ~TaskFindActivityRepeat();
+
+    /**
+     * Returns true if the activity of 'action_t' contains a repeat
+     */
+    bool find(arl::dm::IDataTypeAction *action_t);
+
+	virtual void visitDataTypeAction(arl::dm::IDataTypeAction *t) override;
+
+	virtual void visitDataTypeActivityRepeatCount(
+        arl::dm::IDataTypeActivityRepeatCount *t) override;
+
+	virtual void visitDataTypeActivityRepeatWhile(
+        arl::dm::IDataTypeActivityRepeatWhile *t) override;
+
+private:
+    bool                                    m_found;
+    // Action types already visited; sub-action types are often shared
+    std::set<arl::dm::IDataTypeAction *>    m_visited;
+
+};
+
+}
+}
+
+
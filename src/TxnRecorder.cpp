@@ -0,0 +1,199 @@
+/*
+ * TxnRecorder.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <chrono>
+#include "vsc/dm/IDataTypeInt.h"
+#include "SimTime.h"
+#include "TxnRecorder.h"
+
+
+namespace zsp {
+namespace sv {
+
+static const char TXN_MAGIC[8] = {'Z','S','P','T','X','N','\0','\0'};
+
+TxnRecorder::TxnRecorder(const std::string &path, FILE *fp) :
+        m_path(path), m_fp(fp), m_bytes(0), m_n_txns(0), 
+        m_stop(false), m_flush_req(false), m_writing(false) {
+    uint32_t version = TxnRecord::VERSION;
+    put(TXN_MAGIC, sizeof(TXN_MAGIC));
+    put(&version, sizeof(version));
+    m_thread = std::thread(&TxnRecorder::run, this);
+}
+
+TxnRecorder::~TxnRecorder() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cond.notify_one();
+    }
+    m_thread.join();
+    fclose(m_fp);
+}
+
+TxnRecorder *TxnRecorder::create(const std::string &path) {
+    FILE *fp = fopen(path.c_str(), "wb");
+
+    if (!fp) {
+        return 0;
+    }
+
+    return new TxnRecorder(path, fp);
+}
+
+uint64_t TxnRecorder::begin(
+        int32_t                     actor,
+        arl::dm::IDataTypeAction    *action_t,
+        const vsc::dm::ValRef       &action_v,
+        uint64_t                    parent) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const TypeInfo &type = getType(action_t);
+    uint64_t txn = m_n_txns++;
+    uint64_t time = SimTime::get();
+    uint8_t kind = TxnRecord::Begin;
+
+    put(&kind, sizeof(kind));
+    put(&txn, sizeof(txn));
+    put(&actor, sizeof(actor));
+    put(&type.id, sizeof(type.id));
+    put(&parent, sizeof(parent));
+    put(&time, sizeof(time));
+
+    vsc::dm::ValRefStruct val_s(action_v);
+    for (std::vector<int32_t>::const_iterator
+        it=type.fields.begin();
+        it!=type.fields.end(); it++) {
+        vsc::dm::ValRefInt val(val_s.getFieldRef(*it));
+        uint64_t v = val.get_val_u();
+        put(&v, sizeof(v));
+    }
+
+    if (m_buf.size() >= WRITE_THRESHOLD) {
+        m_cond.notify_one();
+    }
+
+    return txn;
+}
+
+void TxnRecorder::end(uint64_t txn) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t time = SimTime::get();
+    uint8_t kind = TxnRecord::End;
+
+    put(&kind, sizeof(kind));
+    put(&txn, sizeof(txn));
+    put(&time, sizeof(time));
+
+    if (m_buf.size() >= WRITE_THRESHOLD) {
+        m_cond.notify_one();
+    }
+}
+
+void TxnRecorder::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_flush_req = true;
+    m_cond.notify_one();
+    m_flushed.wait(lock, [this]() { return !m_buf.size() && !m_writing; });
+    fflush(m_fp);
+}
+
+const TxnRecorder::TypeInfo &TxnRecorder::getType(
+        arl::dm::IDataTypeAction *action_t) {
+    std::unordered_map<arl::dm::IDataTypeAction *, TypeInfo>::const_iterator it;
+
+    if ((it=m_type_m.find(action_t)) != m_type_m.end()) {
+        return it->second;
+    }
+
+    TypeInfo &type = m_type_m[action_t];
+    type.id = m_type_m.size()-1;
+
+    // Integer fields up to 64 bits are recorded
+    std::vector<std::pair<vsc::dm::ITypeField *, vsc::dm::IDataTypeInt *>> fields;
+    for (uint32_t i=0; i<action_t->getFields().size(); i++) {
+        vsc::dm::ITypeField *field = action_t->getFields().at(i).get();
+        vsc::dm::IDataTypeInt *field_t = 
+            dynamic_cast<vsc::dm::IDataTypeInt *>(field->getDataType());
+
+        if (field_t && field_t->width() > 0 && field_t->width() <= 64) {
+            type.fields.push_back(i);
+            fields.push_back({field, field_t});
+        }
+    }
+
+    uint8_t kind = TxnRecord::Type;
+    uint16_t n_fields = fields.size();
+    put(&kind, sizeof(kind));
+    put(&type.id, sizeof(type.id));
+    putStr(action_t->name());
+    put(&n_fields, sizeof(n_fields));
+    for (std::vector<std::pair<vsc::dm::ITypeField *, vsc::dm::IDataTypeInt *>>::const_iterator
+        f_it=fields.begin();
+        f_it!=fields.end(); f_it++) {
+        uint8_t width = f_it->second->width();
+        uint8_t is_signed = f_it->second->is_signed();
+        putStr(f_it->first->name());
+        put(&width, sizeof(width));
+        put(&is_signed, sizeof(is_signed));
+    }
+
+    return type;
+}
+
+void TxnRecorder::putStr(const std::string &s) {
+    uint16_t len = (s.size() > 0xFFFF)?0xFFFF:s.size();
+    put(&len, sizeof(len));
+    put(s.c_str(), len);
+}
+
+void TxnRecorder::run() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        // Partial buffers are written periodically, so the file stays
+        // close to current if the simulation is killed
+        m_cond.wait_for(lock, std::chrono::milliseconds(100), [this]() { 
+            return m_buf.size() >= WRITE_THRESHOLD || m_flush_req || m_stop; });
+        m_flush_req = false;
+
+        if (m_buf.size()) {
+            m_buf_w.swap(m_buf);
+            m_writing = true;
+            lock.unlock();
+
+            fwrite(m_buf_w.data(), 1, m_buf_w.size(), m_fp);
+            m_bytes.fetch_add(m_buf_w.size(), std::memory_order_relaxed);
+            m_buf_w.clear();
+
+            lock.lock();
+            m_writing = false;
+        }
+
+        if (!m_buf.size()) {
+            m_flushed.notify_all();
+            if (m_stop) {
+                break;
+            }
+        }
+    }
+}
+
+}
+}
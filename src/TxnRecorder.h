@@ -0,0 +1,151 @@
+/**
+ * TxnRecorder.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "zsp/arl/dm/IDataTypeAction.h"
+
+namespace zsp {
+namespace sv {
+
+/**
+ * Record kinds of a transaction file. All values are little-endian and 
+ * records are unaligned. Keep in sync with python/zsp_sv/txn.py
+ *
+ * File:    "ZSPTXN\0\0" u32:version, then records, each led by a u8 kind
+ * Type:    u32:type u16:len name u16:n_fields { u16:len name u8:width u8:signed }
+ * Begin:   u64:txn u32:actor u32:type u64:parent u64:time { u64:value }
+ * End:     u64:txn u64:time
+ *
+ * 'parent' is one more than the enclosing transaction's id, or 0. A Begin
+ * carries one value per field of its type, as solved when the action 
+ * starts. Times are those of SimTime when the record is made.
+ */
+struct TxnRecord {
+    static const uint32_t VERSION = 1;
+
+    enum Kind : uint8_t {
+        Type = 1,
+        Begin = 2,
+        End = 3
+    };
+};
+
+class TxnRecorder;
+using TxnRecorderUP=std::unique_ptr<TxnRecorder>;
+
+/**
+ * Records executed actions, with their solved fields and start/end 
+ * times, to a compact binary file. Records are formatted into a buffer
+ * by the evaluating thread and written by a background writer thread.
+ * Shared by all actors.
+ */
+class TxnRecorder {
+public:
+
+    virtual ~TxnRecorder();
+
+    /**
+     * Creates (truncating) a transaction file. Returns null on failure
+     */
+    static TxnRecorder *create(const std::string &path);
+
+    /**
+     * Records the start of an action. 'parent' is the id of the
+     * enclosing transaction plus one, or 0. Returns the transaction id
+     */
+    uint64_t begin(
+        int32_t                     actor,
+        arl::dm::IDataTypeAction    *action_t,
+        const vsc::dm::ValRef       &action_v,
+        uint64_t                    parent);
+
+    void end(uint64_t txn);
+
+    /**
+     * Waits until all records so far are written
+     */
+    void flush();
+
+    uint64_t numTxns() const {
+        return m_n_txns;
+    }
+
+    uint64_t bytes() const {
+        return m_bytes.load(std::memory_order_relaxed);
+    }
+
+    const std::string &path() const {
+        return m_path;
+    }
+
+private:
+    struct TypeInfo {
+        uint32_t                    id;
+        std::vector<int32_t>        fields;
+    };
+
+    TxnRecorder(const std::string &path, FILE *fp);
+
+    const TypeInfo &getType(arl::dm::IDataTypeAction *action_t);
+
+    void put(const void *data, size_t sz) {
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+        m_buf.insert(m_buf.end(), p, p+sz);
+    }
+
+    void putStr(const std::string &s);
+
+    // Wakes the writer once the buffer reaches this size
+    static const size_t WRITE_THRESHOLD = 64*1024;
+
+    void run();
+
+private:
+    std::string                                                 m_path;
+    FILE                                                        *m_fp;
+    std::atomic<uint64_t>                                       m_bytes;
+    uint64_t                                                    m_n_txns;
+    std::mutex                                                  m_mutex;
+    std::condition_variable                                     m_cond;
+    std::condition_variable                                     m_flushed;
+    bool                                                        m_stop;
+    bool                                                        m_flush_req;
+    bool                                                        m_writing;
+    std::vector<uint8_t>                                        m_buf;
+    std::vector<uint8_t>                                        m_buf_w;
+    std::unordered_map<arl::dm::IDataTypeAction *, TypeInfo>    m_type_m;
+    std::thread                                                 m_thread;
+
+};
+
+}
+}
+
+
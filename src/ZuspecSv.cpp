@@ -19,7 +19,10 @@
  *     Author:
  */
 #include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include "dmgr/FactoryExt.h"
 #include "vsc/dm/FactoryExt.h"
@@ -31,7 +34,10 @@
 #include "zsp/ast/IFactory.h"
 #include "Actor.h"
 #include "EvalBackendProxy.h"
+#include "HeapProf.h"
 #include "MarkerListener.h"
+#include "Probes.h"
+#include "SimTime.h"
 #include "ZuspecSv.h"
 #include "ZuspecSvDpiImp.h"
 
@@ -40,11 +46,15 @@ extern "C" zsp::ast::IFactory *ast_getFactory();
 namespace zsp {
 namespace sv {
 
-
-
 ZuspecSv::ZuspecSv() : 
     m_initialized(false),
-    m_loaded(false) {
+    m_checkpoint(false),
+    m_default(0),
+    m_cov_bias_k(0),
+    m_mem_mode(MemMode::Functional),
+    m_call_stats(false),
+    m_call_timeout_fatal(false),
+    m_next_actor_id(0) {
     m_solver_f = vsc_solvers_getFactory();
 
 
@@ -55,9 +65,9 @@ ZuspecSv::~ZuspecSv() {
 }
 
 ZuspecSv *ZuspecSv::inst() {
-    if (!m_inst) {
+    std::call_once(m_inst_once, []() {
         m_inst = ZuspecSvUP(new ZuspecSv());
-    }
+    });
     return m_inst.get();
 }
 
@@ -65,6 +75,7 @@ bool ZuspecSv::init(
     const std::string       &pss_files,
     bool                    load,
     bool                    debug) {
+    std::unique_lock<std::mutex> lock(m_mutex);
     if (m_initialized) {
         return true;
     }
@@ -77,8 +88,6 @@ bool ZuspecSv::init(
     if (debug) {
         m_dmgr->enable(debug);
     }
-    m_pssfiles = pss_files;
-
     vsc::dm::IFactory *vsc_dm_f = vsc_dm_getFactory();
     vsc_dm_f->init(m_dmgr);
 
@@ -87,9 +96,18 @@ bool ZuspecSv::init(
 
     zsp_arl_eval_getFactory()->init(m_dmgr);
 
+    // Parser factories are shared by all models. Initialize them here,
+    // before any model is loaded on a background thread
+    parser::IFactory *parser_f = zsp_parser_getFactory();
+    parser_f->init(
+        m_dmgr,
+        ast_getFactory());
+    zsp_fe_parser_getFactory()->init(m_dmgr, parser_f);
+
+    m_initialized = true;
 
-    m_ctxt = arl::dm::IContextUP(arl_dm_f->mkContext(
-        vsc_dm_f->mkContext()));
+    m_default = newModel("", pss_files);
+    lock.unlock();
 
     if (load) {
         if (!ensureLoaded()) {
@@ -111,101 +129,485 @@ bool ZuspecSv::init(
 
 //    parser::IAstBuilderUP builder(parser_f->mkAstBuilder());
 
-    m_initialized = true;
-
     return true;
 }
 
 bool ZuspecSv::ensureLoaded() {
+    return (m_default)?m_default->ensureLoaded():false;
+}
+
+Model *ZuspecSv::mkModel(
+        const std::string               &name,
+        const std::string               &pss_files) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return newModel(name, pss_files);
+}
+
+Model *ZuspecSv::newModel(
+        const std::string               &name,
+        const std::string               &pss_files) {
+    char tmp[1024];
+
+    if (!m_initialized) {
+        zuspec_fatal("mkModel: zuspec is not initialized");
+        return 0;
+    }
+
+    if (m_model_m.find(name) != m_model_m.end()) {
+        snprintf(tmp, sizeof(tmp), "Model %s already exists", name.c_str());
+        zuspec_error(tmp);
+        return 0;
+    }
+
+    Model *model = new Model(
+        m_dmgr,
+        name,
+        pss_files,
+        zsp_arl_dm_getFactory()->mkContext(vsc_dm_getFactory()->mkContext()));
+    m_model_m.insert({name, ModelUP(model)});
+
+    return model;
+}
+
+Model *ZuspecSv::findModel(const std::string &name) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, ModelUP>::const_iterator it = m_model_m.find(name);
+    return (it != m_model_m.end())?it->second.get():0;
+}
+
+Actor *ZuspecSv::mkActor(
+        Model                           *model,
+        const std::string               &seed,
+        const std::string               &comp_t_s,
+        const std::string               &action_t_s,
+        arl::eval::IEvalBackend         *backend) {
+    char tmp[1024];
+
+    if (!model) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        model = m_default;
+    }
+
+    // Models serialize their own loading, so a load (or a join on a 
+    // background load) doesn't block other models
+    if (!model || !model->ensureLoaded()) {
+        zuspec_fatal("Failed to load PSS files");
+        return 0;
+    }
+
+    // Elaboration may add types to the context, so lookups and the 
+    // actor's elaboration are serialized per model. Actors of different
+    // models are created concurrently
+    arl::dm::IContext *ctxt = model->ctxt();
+    std::unique_lock<std::mutex> elab_lock(model->elabMutex());
+
+    vsc::dm::IDataTypeStruct *comp_s = ctxt->findDataTypeStruct(comp_t_s);
+    if (!comp_s) {
+        snprintf(tmp, sizeof(tmp), "Failed to find component %s", comp_t_s.c_str());
+        zuspec_fatal(tmp);
+        return 0;
+    }
+    arl::dm::IDataTypeComponent *comp_t = dynamic_cast<arl::dm::IDataTypeComponent *>(comp_s);
+    if (!comp_t) {
+        snprintf(tmp, sizeof(tmp), "Type %s is not a component", comp_t_s.c_str());
+        zuspec_fatal(tmp);
+        return 0;
+    }
+
+    vsc::dm::IDataTypeStruct *action_s = ctxt->findDataTypeStruct(action_t_s);
+    if (!action_s) {
+        snprintf(tmp, sizeof(tmp), "Failed to find action %s", action_t_s.c_str());
+        zuspec_fatal(tmp);
+        return 0;
+    }
+    arl::dm::IDataTypeAction *action_t = dynamic_cast<arl::dm::IDataTypeAction *>(action_s);
+    if (!action_t) {
+        snprintf(tmp, sizeof(tmp), "Type %s is not an action", action_t_s.c_str());
+        zuspec_fatal(tmp);
+        return 0;
+    }
+    // The actor takes the model's lock to elaborate
+    elab_lock.unlock();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    bool checkpoint = m_checkpoint;
+    lock.unlock();
+
+    Actor *actor = new Actor(
+        nextActorId(),
+        model,
+        seed,
+        comp_t,
+        action_t,
+        backend,
+        checkpoint);
+
+    lock.lock();
+    if (m_cov) {
+        actor->setCoverage(m_cov.get());
+        if (m_cov_bias_k > 1) {
+            actor->setCoverageFeedback(m_cov_bias_k, m_cov_prior.get());
+        }
+    }
+
+    if (m_txn) {
+        actor->setRecorder(m_txn.get());
+    }
+
+    if (m_mem) {
+        actor->setMem(m_mem.get(), m_mem_mode);
+    }
+
+    actor->setCallTracking(m_call_stats);
+    for (std::map<std::string, uint64_t>::const_iterator
+        it=m_call_timeout_m.begin();
+        it!=m_call_timeout_m.end(); it++) {
+        actor->setCallTimeout(it->first, it->second);
+    }
+    actor->setCallTimeoutFatal(m_call_timeout_fatal);
+
+    for (std::map<std::string, std::pair<uint32_t,uint32_t>>::const_iterator
+        it=m_table_cfg_m.begin();
+        it!=m_table_cfg_m.end(); it++) {
+        if (checkpoint) {
+            // A journal can't capture what other actors contribute to a 
+            // shared table, so journaled actors learn on their own
+            actor->addSolutionTable(it->first, 
+                it->second.first, it->second.second);
+            continue;
+        }
+        SolutionTableUP &table = m_table_m[{model, it->first}];
+        if (!table) {
+            table = SolutionTableUP(new SolutionTable(
+                it->second.first, it->second.second));
+        }
+        actor->addSolutionTable(it->first, table.get());
+    }
+    lock.unlock();
+
+    addActor(actor);
+
+    return actor;
+}
+
+void ZuspecSv::addActor(Actor *actor) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_actors.push_back(actor);
+    if (StatsShm::block()) {
+        StatsShm::block()->actors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool ZuspecSv::enableStats(const std::string &name) {
     char tmp[1024];
-    if (m_loaded) {
+    // Actors may be registered concurrently (addActor), and are counted
+    // either here or there
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_stats) {
         return true;
     }
 
-    if (m_pssfiles == "") {
-        zuspec_message("No PSS files specified");
+    std::string shm_name = name;
+    if (shm_name == "") {
+        snprintf(tmp, sizeof(tmp), "/zsp-sv-%d", getpid());
+        shm_name = tmp;
+    } else if (shm_name.at(0) != '/') {
+        shm_name = "/" + shm_name;
+    }
+
+    m_stats = StatsShmUP(StatsShm::create(shm_name));
+
+    if (!m_stats) {
+        snprintf(tmp, sizeof(tmp), "Failed to create stats segment %s", shm_name.c_str());
+        zuspec_error(tmp);
         return false;
     }
 
-    snprintf(tmp, sizeof(tmp), "Parsing %s", m_pssfiles.c_str());
+    StatsShm::setActive(m_stats.get());
+    StatsShm::block()->actors = m_actors.size();
+
+    snprintf(tmp, sizeof(tmp), "Publishing statistics in %s", shm_name.c_str());
     zuspec_message(tmp);
 
-    MarkerListener listener;
-    parser::IFactory *parser_f = zsp_parser_getFactory();
-    parser_f->init(
-        m_dmgr,
-        ast_getFactory());
-    parser::IAstBuilderUP builder(parser_f->mkAstBuilder(&listener));
-    std::vector<ast::IGlobalScopeUP> scopes;
+    return true;
+}
 
-    scopes.push_back(parser_f->getAstFactory()->mkGlobalScope(0));
-    parser_f->loadStandardLibrary(builder.get(), scopes.back().get());
+bool ZuspecSv::enableCheckpoint() {
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-    scopes.push_back(parser_f->getAstFactory()->mkGlobalScope(1));
+    // Biased solves pick a solution based on live coverage counts, which 
+    // are not journaled, so a replay would silently diverge
+    if (m_cov_bias_k > 1) {
+        zuspec_error("Checkpointing (+zuspec.checkpoint) cannot be combined with coverage feedback (+zuspec.cov_bias)");
+        return false;
+    }
 
+    m_checkpoint = true;
 
-    std::fstream s;
+    return true;
+}
 
-    s.open(m_pssfiles, std::fstream::in);
+void ZuspecSv::addSolutionTable(
+        const std::string               &type,
+        uint32_t                        max_size,
+        uint32_t                        saturate) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table_cfg_m[type] = {max_size, saturate};
+}
 
-    if (!s.is_open()) {
-        snprintf(tmp, sizeof(tmp), "Failed to open file %s", m_pssfiles.c_str());
-        zuspec_fatal(tmp);
+bool ZuspecSv::enableCoverage(const std::string &path) {
+    char tmp[1024];
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_cov) {
+        zuspec_error("Coverage collection is already enabled");
+        return false;
+    }
+
+    m_cov = CovDbUP(CovDb::create(path));
+
+    if (!m_cov) {
+        snprintf(tmp, sizeof(tmp), "Failed to create coverage database %s", path.c_str());
+        zuspec_error(tmp);
+        return false;
+    }
+
+    return true;
+}
+
+bool ZuspecSv::enableMem(const std::string &mode) {
+    char tmp[1024];
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (mode == "functional") {
+        m_mem_mode = MemMode::Functional;
+    } else if (mode == "shadow") {
+        m_mem_mode = MemMode::Shadow;
+    } else {
+        snprintf(tmp, sizeof(tmp), 
+            "Unknown memory mode %s (expect functional or shadow)", mode.c_str());
+        zuspec_error(tmp);
         return false;
     }
 
-    builder->build(
-        scopes.back().get(),
-        &s);
-    
-    if (listener.hasSeverity(parser::MarkerSeverityE::Error)) {
-        zuspec_fatal("Parse errors");
+    if (!m_mem) {
+        m_mem = SparseMemUP(new SparseMem());
+    }
+
+    return true;
+}
+
+void ZuspecSv::enableCallStats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_call_stats = true;
+}
+
+void ZuspecSv::setCallTimeout(const std::string &func, uint64_t timeout) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_call_timeout_m[func] = timeout;
+    m_call_stats = true;
+}
+
+void ZuspecSv::setCallTimeoutFatal(bool en) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_call_timeout_fatal = en;
+}
+
+bool ZuspecSv::enableRecording(const std::string &path) {
+    char tmp[1024];
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_txn) {
+        zuspec_error("Transaction recording is already enabled");
         return false;
     }
-    
-    std::vector<ast::IGlobalScope *> scopes_p;
-    for (std::vector<ast::IGlobalScopeUP>::const_iterator
-        it=scopes.begin();
-        it!=scopes.end(); it++) {
-        scopes_p.push_back(it->get());
+
+    m_txn = TxnRecorderUP(TxnRecorder::create(path));
+
+    if (!m_txn) {
+        snprintf(tmp, sizeof(tmp), "Failed to create transaction file %s", path.c_str());
+        zuspec_error(tmp);
+        return false;
     }
 
-    parser::ILinkerUP linker(parser_f->mkAstLinker());
-    ast::ISymbolScopeUP scope(linker->link(
-        &listener,
-        scopes_p
-    ));
+    return true;
+}
+
+bool ZuspecSv::enableCoverageFeedback(uint32_t k, const std::string &prior) {
+    char tmp[1024];
+    std::string err;
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-    if (listener.hasSeverity(parser::MarkerSeverityE::Error)) {
-        zuspec_fatal("Linking errors");
+    if (!m_cov) {
+        zuspec_error("Coverage feedback requires coverage collection (+zuspec.cov)");
         return false;
     }
 
-    fe::parser::IFactory *fe_parser_f = zsp_fe_parser_getFactory();
-    fe_parser_f->init(m_dmgr, parser_f);
-    fe::parser::IAst2ArlContextUP builder_ctxt(fe_parser_f->mkAst2ArlContext(
-        m_ctxt.get(),
-        scope.get(),
-        &listener
-    ));
-    fe::parser::IAst2ArlBuilderUP fe_builder(fe_parser_f->mkAst2ArlBuilder());
-    fe_builder->build(
-        scope.get(),
-        builder_ctxt.get()
-    );
-
-    if (listener.hasSeverity(parser::MarkerSeverityE::Error)) {
-        zuspec_fatal("Data-model build errors");
+    if (m_checkpoint) {
+        zuspec_error("Coverage feedback (+zuspec.cov_bias) cannot be combined with checkpointing (+zuspec.checkpoint)");
         return false;
     }
 
+    if (prior != "") {
+        m_cov_prior = CovDbUP(CovDb::open(prior, false, err));
+        if (!m_cov_prior) {
+            snprintf(tmp, sizeof(tmp), "Failed to open prior coverage database %s: %s",
+                prior.c_str(), err.c_str());
+            zuspec_error(tmp);
+            return false;
+        }
+    }
 
-    m_loaded = true;
+    m_cov_bias_k = k;
 
     return true;
 }
 
+void ZuspecSv::report() {
+    char tmp[1024];
+
+    if (m_cov) {
+        const CovDbHeader *hdr = m_cov->header();
+        uint64_t n_hit = 0;
+        for (uint32_t i=0; i<hdr->n_items; i++) {
+            n_hit += m_cov->numHit(i);
+        }
+        m_cov->sync();
+        snprintf(tmp, sizeof(tmp),
+            "Coverage: %u items, %llu/%llu bins hit (%.1f%%) in %s",
+            hdr->n_items,
+            (unsigned long long)n_hit,
+            (unsigned long long)hdr->n_bins,
+            (hdr->n_bins)?(100.0*n_hit)/hdr->n_bins:0.0,
+            m_cov->path().c_str());
+        zuspec_message(tmp);
+    }
+
+    if (m_txn) {
+        m_txn->flush();
+        snprintf(tmp, sizeof(tmp),
+            "Transactions: %llu recorded (%llu bytes) in %s",
+            (unsigned long long)m_txn->numTxns(),
+            (unsigned long long)m_txn->bytes(),
+            m_txn->path().c_str());
+        zuspec_message(tmp);
+    }
+
+    if (m_mem) {
+        snprintf(tmp, sizeof(tmp),
+            "Memory: %llu pages, %llu accesses served, %llu reads checked, %llu mismatches",
+            (unsigned long long)m_mem->numPages(),
+            (unsigned long long)m_mem->n_served.load(),
+            (unsigned long long)m_mem->n_checked.load(),
+            (unsigned long long)m_mem->n_mismatch.load());
+        zuspec_message(tmp);
+    }
+
+    HeapProf::report();
+    if (HeapProf::enabled()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::vector<Actor *>::const_iterator
+            it=m_actors.begin();
+            it!=m_actors.end(); it++) {
+            const HeapStats &s = (*it)->getHeapStats();
+            snprintf(tmp, sizeof(tmp),
+                "Heap: %-24s alloc=%llu (%llu allocs) net=%llu",
+                s.name.c_str(),
+                (unsigned long long)s.alloc_bytes,
+                (unsigned long long)s.alloc_count,
+                (unsigned long long)s.liveBytes());
+            zuspec_message(tmp);
+        }
+    }
+
+    // Call latency per function, summed over actors and listed by count
+    std::map<std::string, CallStats> call_stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::vector<Actor *>::const_iterator
+            it=m_actors.begin();
+            it!=m_actors.end(); it++) {
+            std::map<std::string, CallStats> stats = (*it)->getCallStats();
+            for (std::map<std::string, CallStats>::const_iterator
+                c_it=stats.begin();
+                c_it!=stats.end(); c_it++) {
+                call_stats[c_it->first].add(c_it->second);
+            }
+        }
+    }
+
+    std::vector<std::pair<std::string, CallStats>> by_count(
+        call_stats.begin(), call_stats.end());
+    std::stable_sort(by_count.begin(), by_count.end(),
+        [](const std::pair<std::string, CallStats> &a,
+            const std::pair<std::string, CallStats> &b) {
+            return a.second.count > b.second.count;
+        });
+
+    for (std::vector<std::pair<std::string, CallStats>>::const_iterator
+        it=by_count.begin();
+        it!=by_count.end(); it++) {
+        const CallStats &s = it->second;
+        snprintf(tmp, sizeof(tmp),
+            "Call: %-24s count=%llu mean=%.1f p50=%llu p90=%llu p99=%llu max=%llu timeouts=%llu",
+            it->first.c_str(),
+            (unsigned long long)s.count,
+            (s.count)?((double)s.total)/s.count:0.0,
+            (unsigned long long)s.percentile(50),
+            (unsigned long long)s.percentile(90),
+            (unsigned long long)s.percentile(99),
+            (unsigned long long)s.max,
+            (unsigned long long)s.timeouts);
+        zuspec_message(tmp);
+    }
+
+    // Solve statistics per action/struct type, summed over actors and
+    // listed by total solve time
+    std::map<std::string, SolveStats> type_stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (std::vector<Actor *>::const_iterator
+            it=m_actors.begin();
+            it!=m_actors.end(); it++) {
+            std::map<std::string, SolveStats> stats = (*it)->getSolveTypeStats();
+            for (std::map<std::string, SolveStats>::const_iterator
+                t_it=stats.begin();
+                t_it!=stats.end(); t_it++) {
+                type_stats[t_it->first].add(t_it->second);
+            }
+        }
+    }
+
+    std::vector<std::pair<std::string, SolveStats>> by_time(
+        type_stats.begin(), type_stats.end());
+    std::stable_sort(by_time.begin(), by_time.end(),
+        [](const std::pair<std::string, SolveStats> &a,
+            const std::pair<std::string, SolveStats> &b) {
+            return a.second.time_ns > b.second.time_ns;
+        });
+
+    for (std::vector<std::pair<std::string, SolveStats>>::const_iterator
+        it=by_time.begin();
+        it!=by_time.end(); it++) {
+        const SolveStats &s = it->second;
+        snprintf(tmp, sizeof(tmp),
+            "Solve: %-24s count=%llu time=%.3fms avg=%.1fus max=%.1fus vars=%.1f failures=%llu retries=%llu table=%llu",
+            it->first.c_str(),
+            (unsigned long long)s.count,
+            s.time_ns/1e6,
+            (s.count)?(s.time_ns/1e3)/s.count:0.0,
+            s.max_time_ns/1e3,
+            (s.count)?((double)s.vars)/s.count:0.0,
+            (unsigned long long)s.failures,
+            (unsigned long long)s.retries,
+            (unsigned long long)s.table_hits);
+        zuspec_message(tmp);
+    }
+}
+
 ZuspecSvUP ZuspecSv::m_inst;
+std::once_flag ZuspecSv::m_inst_once;
 
 }
 }
@@ -213,114 +615,376 @@ ZuspecSvUP ZuspecSv::m_inst;
 /****************************************************************************
  * DPI Interface
  ****************************************************************************/
-static char dpiStrBuf[1024];
+// Strings returned to SV must outlive the call. Simulators may call in
+// from several threads, so each has its own buffer
+static thread_local char dpiStrBuf[1024];
 
-extern "C" uint32_t zuspec_init(
+ZUSPEC_DPI_EXPORT uint32_t zuspec_init(
     const char      *pss_files,
     int             load,
     int             debug) {
     return zsp::sv::ZuspecSv::inst()->init(pss_files, load, debug);
 }
 
-extern "C" void zuspec_enableDebug(int en) {
+ZUSPEC_DPI_EXPORT void zuspec_enableDebug(int en) {
     zsp::sv::ZuspecSv *zsp_sv = zsp::sv::ZuspecSv::inst();
     zsp_sv->getDebugMgr()->enable(en);
 }
 
-extern "C" chandle zuspec_Actor_new(
+ZUSPEC_DPI_EXPORT int32_t zuspec_enableStats(const char *name) {
+    return zsp::sv::ZuspecSv::inst()->enableStats(name);
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_enableCoverage(const char *path) {
+    return zsp::sv::ZuspecSv::inst()->enableCoverage(path);
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_enableCoverageFeedback(
+        uint32_t        k,
+        const char      *prior) {
+    return zsp::sv::ZuspecSv::inst()->enableCoverageFeedback(k, prior);
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_enableMem(const char *mode) {
+    return zsp::sv::ZuspecSv::inst()->enableMem(mode);
+}
+
+// Bulk transfers between the sparse memory and SV, in chunks of up to
+// one page. Imported without 'context'
+ZUSPEC_DPI_EXPORT void zuspec_memWrite(
+    uint64_t        addr,
+    const uint8_t   *data,
+    uint32_t        n) {
+    zsp::sv::SparseMem *mem = zsp::sv::ZuspecSv::inst()->getMem();
+    if (mem) {
+        mem->write(addr, data, n);
+    }
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_memRead(
+    uint64_t        addr,
+    uint8_t         *data,
+    uint32_t        n) {
+    zsp::sv::SparseMem *mem = zsp::sv::ZuspecSv::inst()->getMem();
+    return (mem)?mem->read(addr, data, n):0;
+}
+
+// Fills 'addrs' with up to 'max' allocated page addresses at or above
+// 'from', in address order. Returns the number copied. A walk continues
+// from the page after the last one returned, so no state is kept between
+// calls and concurrent walks are independent
+ZUSPEC_DPI_EXPORT int32_t zuspec_memGetPages(
+    uint64_t        *addrs,
+    uint64_t        from,
+    uint32_t        max) {
+    zsp::sv::SparseMem *mem = zsp::sv::ZuspecSv::inst()->getMem();
+    return (mem)?mem->pages(from, addrs, max):0;
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_enableRecording(const char *path) {
+    return zsp::sv::ZuspecSv::inst()->enableRecording(path);
+}
+
+// Imported without 'context' so it is cheap to call on every step
+ZUSPEC_DPI_EXPORT void zuspec_setTime(uint64_t time) {
+    zsp::sv::SimTime::set(time);
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_report() {
+    zsp::sv::ZuspecSv::inst()->report();
+}
+
+ZUSPEC_DPI_EXPORT chandle zuspec_Model_new(
+    const char          *name,
+    const char          *pss_files) {
+    return reinterpret_cast<chandle>(
+        zsp::sv::ZuspecSv::inst()->mkModel(name, pss_files));
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_Model_loadAsync(chandle model_h) {
+    reinterpret_cast<zsp::sv::Model *>(model_h)->loadAsync();
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Model_ensureLoaded(chandle model_h) {
+    return reinterpret_cast<zsp::sv::Model *>(model_h)->ensureLoaded();
+}
+
+ZUSPEC_DPI_EXPORT chandle zuspec_Actor_new(
+    chandle              model_h,
     const char          *seed,
     const char          *comp_t_s,
     const char          *action_t_s,
     uint64_t             backend_h) {
-    char tmp[1024];
-    zsp::sv::ZuspecSv *zsp_sv = zsp::sv::ZuspecSv::inst();
-    zsp::arl::dm::IContext *ctxt = zsp_sv->ctxt();
     zsp::sv::EvalBackendProxy *backend = reinterpret_cast<zsp::sv::EvalBackendProxy *>(backend_h);
 
-    if (!zsp_sv->ensureLoaded()) {
-        zuspec_fatal("Failed to load PSS files");
-        return 0;
-    }
+    zsp::sv::Actor *actor = zsp::sv::ZuspecSv::inst()->mkActor(
+        reinterpret_cast<zsp::sv::Model *>(model_h),
+        seed,
+        comp_t_s,
+        action_t_s,
+        backend);
 
-    vsc::dm::IDataTypeStruct *comp_s = ctxt->findDataTypeStruct(comp_t_s);
-    if (!comp_s) {
-        snprintf(tmp, sizeof(tmp), "Failed to find component %s", comp_t_s);
-        zuspec_fatal(tmp);
-        return 0;
-    }
-    zsp::arl::dm::IDataTypeComponent *comp_t = dynamic_cast<zsp::arl::dm::IDataTypeComponent *>(comp_s);
-    if (!comp_t) {
-        snprintf(tmp, sizeof(tmp), "Type %s is not a component", comp_t_s);
-        zuspec_fatal(tmp);
-        return 0;
+    if (actor) {
+        backend->setActor(actor);
     }
 
-    vsc::dm::IDataTypeStruct *action_s = ctxt->findDataTypeStruct(action_t_s);
-    if (!action_s) {
-        snprintf(tmp, sizeof(tmp), "Failed to find action %s", action_t_s);
-        zuspec_fatal(tmp);
-        return 0;
+    return reinterpret_cast<chandle>(actor);
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_eval(
+    chandle     actor_h) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->eval();
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_evalBudget(
+    chandle     actor_h,
+    uint64_t    max_us) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->evalBudget(max_us);
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_setAsync(
+    chandle     actor_h,
+    int32_t     en) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->setAsync(en);
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_Actor_evalRequest(chandle actor_h) {
+    zsp::sv::AsyncEval *async = reinterpret_cast<zsp::sv::Actor *>(actor_h)->getAsync();
+    if (async) {
+        async->request();
+    } else {
+        zuspec_error("zuspec_Actor_evalRequest requires an async actor");
     }
-    zsp::arl::dm::IDataTypeAction *action_t = dynamic_cast<zsp::arl::dm::IDataTypeAction *>(action_s);
-    if (!action_t) {
-        snprintf(tmp, sizeof(tmp), "Type %s is not an action", action_t_s);
-        zuspec_fatal(tmp);
-        return 0;
+}
+
+// Imported without 'context' so simulators can call it cheaply on every
+// clock edge. Must not call back into SV
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_poll(chandle actor_h) {
+    zsp::sv::AsyncEval *async = reinterpret_cast<zsp::sv::Actor *>(actor_h)->getAsync();
+    return (async)?async->poll():0;
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_dispatch(chandle actor_h) {
+    zsp::sv::AsyncEval *async = reinterpret_cast<zsp::sv::Actor *>(actor_h)->getAsync();
+    return (async)?async->dispatch():0;
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_setStreaming(
+    chandle     actor_h,
+    uint64_t    count,
+    int32_t     window) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->setStreaming(count, window);
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_Actor_setActionEvents(
+    chandle     actor_h,
+    int32_t     en) {
+    reinterpret_cast<zsp::sv::Actor *>(actor_h)->setActionEvents(en);
+}
+
+// Imported without 'context': copies queued events into an SV array
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_drainActionEvents(
+    chandle     actor_h,
+    uint64_t    *buf,
+    uint32_t    max) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->drainActionEvents(buf, max);
+}
+
+ZUSPEC_DPI_EXPORT const char *zuspec_Actor_getActionTypeName(
+    chandle     actor_h,
+    uint32_t    id) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->getActionTypeName(id).c_str();
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_enableCheckpoint() {
+    return zsp::sv::ZuspecSv::inst()->enableCheckpoint();
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_save(
+    chandle     actor_h,
+    const char  *path) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->save(path);
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_restore(
+    chandle     actor_h,
+    const char  *path,
+    const char  *seed) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->restore(path, seed);
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_addSolutionTable(
+    const char  *type,
+    uint32_t    max_size,
+    uint32_t    saturate) {
+    zsp::sv::ZuspecSv::inst()->addSolutionTable(type, max_size, saturate);
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_Actor_addSolutionTable(
+    chandle     actor_h,
+    const char  *type,
+    uint32_t    max_size,
+    uint32_t    saturate) {
+    reinterpret_cast<zsp::sv::Actor *>(actor_h)->addSolutionTable(
+        type, max_size, saturate);
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_getSolveStatsNumTypes(chandle actor_h) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->getSolveTypeStatsList().size();
+}
+
+// Returns the name of the idx'th solved type, and its statistics. Types 
+// are ordered by name
+ZUSPEC_DPI_EXPORT const char *zuspec_Actor_getSolveTypeStats(
+    chandle     actor_h,
+    int32_t     idx,
+    uint64_t    *count,
+    uint64_t    *time_ns,
+    uint64_t    *vars,
+    uint64_t    *failures,
+    uint64_t    *retries) {
+    const std::vector<std::pair<std::string, zsp::sv::SolveStats>> &stats = 
+        reinterpret_cast<zsp::sv::Actor *>(actor_h)->getSolveTypeStatsList();
+
+    if (idx < 0 || idx >= (int32_t)stats.size()) {
+        return "";
     }
 
-    zsp::sv::Actor *actor = new zsp::sv::Actor(
-        ctxt,
-        seed,
-        comp_t,
-        action_t,
-        backend);
+    std::vector<std::pair<std::string, zsp::sv::SolveStats>>::const_iterator it = 
+        stats.begin() + idx;
+    *count = it->second.count;
+    *time_ns = it->second.time_ns;
+    *vars = it->second.vars;
+    *failures = it->second.failures;
+    *retries = it->second.retries;
+    snprintf(dpiStrBuf, sizeof(dpiStrBuf), "%s", it->first.c_str());
+    return dpiStrBuf;
+}
 
-    return reinterpret_cast<chandle>(actor);
+ZUSPEC_DPI_EXPORT void zuspec_enableCallStats() {
+    zsp::sv::ZuspecSv::inst()->enableCallStats();
 }
 
-extern "C" int32_t zuspec_Actor_eval(
-    chandle     actor_h) {
-    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->eval();
+ZUSPEC_DPI_EXPORT void zuspec_setCallTimeout(
+    const char  *func,
+    uint64_t    timeout) {
+    zsp::sv::ZuspecSv::inst()->setCallTimeout(func, timeout);
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_setCallTimeoutFatal(int32_t en) {
+    zsp::sv::ZuspecSv::inst()->setCallTimeoutFatal(en != 0);
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_Actor_setCallTimeout(
+    chandle     actor_h,
+    const char  *func,
+    uint64_t    timeout) {
+    reinterpret_cast<zsp::sv::Actor *>(actor_h)->setCallTimeout(func, timeout);
+}
+
+ZUSPEC_DPI_EXPORT void zuspec_Actor_setCallTimeoutFatal(
+    chandle     actor_h,
+    int32_t     en) {
+    reinterpret_cast<zsp::sv::Actor *>(actor_h)->setCallTimeoutFatal(en != 0);
 }
 
-extern "C" uint32_t zuspec_Actor_registerFunctionId(
+ZUSPEC_DPI_EXPORT uint64_t zuspec_Actor_getMinCallTimeout(chandle actor_h) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->getMinCallTimeout();
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_checkCallTimeouts(chandle actor_h) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->checkCallTimeouts();
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_getCallStatsNumFuncs(chandle actor_h) {
+    return reinterpret_cast<zsp::sv::Actor *>(actor_h)->getCallStatsList().size();
+}
+
+// Returns the name of the idx'th called function, and its latency 
+// statistics. Functions are ordered by name
+ZUSPEC_DPI_EXPORT const char *zuspec_Actor_getCallStats(
+    chandle     actor_h,
+    int32_t     idx,
+    uint64_t    *count,
+    uint64_t    *p50,
+    uint64_t    *p90,
+    uint64_t    *p99,
+    uint64_t    *max,
+    uint64_t    *timeouts) {
+    const std::vector<std::pair<std::string, zsp::sv::CallStats>> &stats = 
+        reinterpret_cast<zsp::sv::Actor *>(actor_h)->getCallStatsList();
+
+    if (idx < 0 || idx >= (int32_t)stats.size()) {
+        return "";
+    }
+
+    std::vector<std::pair<std::string, zsp::sv::CallStats>>::const_iterator it = 
+        stats.begin() + idx;
+    *count = it->second.count;
+    *p50 = it->second.percentile(50);
+    *p90 = it->second.percentile(90);
+    *p99 = it->second.percentile(99);
+    *max = it->second.max;
+    *timeouts = it->second.timeouts;
+    snprintf(dpiStrBuf, sizeof(dpiStrBuf), "%s", it->first.c_str());
+    return dpiStrBuf;
+}
+
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_getHeapStats(
+    chandle     actor_h,
+    uint64_t    *alloc_bytes,
+    uint64_t    *alloc_count,
+    uint64_t    *live_bytes) {
+    const zsp::sv::HeapStats &s = 
+        reinterpret_cast<zsp::sv::Actor *>(actor_h)->getHeapStats();
+    *alloc_bytes = s.alloc_bytes;
+    *alloc_count = s.alloc_count;
+    *live_bytes = s.liveBytes();
+    return zsp::sv::HeapProf::enabled();
+}
+
+ZUSPEC_DPI_EXPORT uint32_t zuspec_Actor_registerFunctionId(
     chandle     actor_h,
     const char  *name,
     int32_t     id) {
     return reinterpret_cast<zsp::sv::Actor *>(actor_h)->registerFunctionId(name, id);
 }
 
-extern "C" int32_t zuspec_Actor_getFunctionId(
+ZUSPEC_DPI_EXPORT int32_t zuspec_Actor_getFunctionId(
     chandle     actor_h,
     chandle     func_h) {
     return reinterpret_cast<zsp::sv::Actor *>(actor_h)->getFunctionId(
         reinterpret_cast<zsp::arl::dm::IDataTypeFunction *>(func_h));
 }
 
-extern "C" const char *zuspec_DataTypeFunction_name(
+ZUSPEC_DPI_EXPORT const char *zuspec_DataTypeFunction_name(
     chandle     func_h) {
-    strcpy(dpiStrBuf, 
+    snprintf(dpiStrBuf, sizeof(dpiStrBuf), "%s",
         reinterpret_cast<zsp::arl::dm::IDataTypeFunction *>(func_h)->name().c_str());
     return dpiStrBuf;
 }
 
-extern "C" void zuspec_EvalThread_setVoidResult(
+ZUSPEC_DPI_EXPORT void zuspec_EvalThread_setVoidResult(
+    chandle     actor_h,
     chandle     thread_h) {
-    reinterpret_cast<zsp::arl::eval::IEvalThread *>(thread_h)->setFlags(
-        zsp::arl::eval::EvalFlags::Complete);
+    reinterpret_cast<zsp::sv::Actor *>(actor_h)->setVoidResult(
+        reinterpret_cast<zsp::arl::eval::IEvalThread *>(thread_h));
 }
 
-extern "C" void zuspec_EvalThread_setIntResult(
+ZUSPEC_DPI_EXPORT void zuspec_EvalThread_setIntResult(
+    chandle      actor_h,
     chandle      thread_h,
     int64_t      value,
     int          is_signed,
     int          width) {
-    zsp::arl::eval::IEvalThread *thread = 
-        reinterpret_cast<zsp::arl::eval::IEvalThread *>(thread_h);
-    thread->setResult(thread->mkValRefInt(value, is_signed, width));
+    reinterpret_cast<zsp::sv::Actor *>(actor_h)->setIntResult(
+        reinterpret_cast<zsp::arl::eval::IEvalThread *>(thread_h),
+        value,
+        is_signed,
+        width);
 }
 
-extern "C" uint64_t zuspec_EvalThread_getAddrHandleValue(
+ZUSPEC_DPI_EXPORT uint64_t zuspec_EvalThread_getAddrHandleValue(
     chandle     thread_h,
     chandle     valref_h) {
     zsp::arl::eval::IEvalThread *thread = 
@@ -330,49 +994,49 @@ extern "C" uint64_t zuspec_EvalThread_getAddrHandleValue(
     return value.get_val_u();
 }
 
-extern "C" uint8_t zuspec_ValRef_get_uint8(chandle valref_h) {
+ZUSPEC_DPI_EXPORT uint8_t zuspec_ValRef_get_uint8(chandle valref_h) {
     vsc::dm::ValRef *valref = reinterpret_cast<vsc::dm::ValRef *>(valref_h);
     vsc::dm::ValRefInt valref_i(*valref);
     return valref_i.get_val_u();
 }
 
-extern "C" int8_t zuspec_ValRef_get_int8(chandle valref_h) {
+ZUSPEC_DPI_EXPORT int8_t zuspec_ValRef_get_int8(chandle valref_h) {
     vsc::dm::ValRef *valref = reinterpret_cast<vsc::dm::ValRef *>(valref_h);
     vsc::dm::ValRefInt valref_i(*valref);
     return valref_i.get_val_s();
 }
 
-extern "C" uint16_t zuspec_ValRef_get_uint16(chandle valref_h) {
+ZUSPEC_DPI_EXPORT uint16_t zuspec_ValRef_get_uint16(chandle valref_h) {
     vsc::dm::ValRef *valref = reinterpret_cast<vsc::dm::ValRef *>(valref_h);
     vsc::dm::ValRefInt valref_i(*valref);
     return valref_i.get_val_u();
 }
 
-extern "C" int16_t zuspec_ValRef_get_int16(chandle valref_h) {
+ZUSPEC_DPI_EXPORT int16_t zuspec_ValRef_get_int16(chandle valref_h) {
     vsc::dm::ValRef *valref = reinterpret_cast<vsc::dm::ValRef *>(valref_h);
     vsc::dm::ValRefInt valref_i(*valref);
     return valref_i.get_val_s();
 }
 
-extern "C" uint32_t zuspec_ValRef_get_uint32(chandle valref_h) {
+ZUSPEC_DPI_EXPORT uint32_t zuspec_ValRef_get_uint32(chandle valref_h) {
     vsc::dm::ValRef *valref = reinterpret_cast<vsc::dm::ValRef *>(valref_h);
     vsc::dm::ValRefInt valref_i(*valref);
     return valref_i.get_val_u();
 }
 
-extern "C" int32_t zuspec_ValRef_get_int32(chandle valref_h) {
+ZUSPEC_DPI_EXPORT int32_t zuspec_ValRef_get_int32(chandle valref_h) {
     vsc::dm::ValRef *valref = reinterpret_cast<vsc::dm::ValRef *>(valref_h);
     vsc::dm::ValRefInt valref_i(*valref);
     return valref_i.get_val_s();
 }
 
-extern "C" uint64_t zuspec_ValRef_get_uint64(chandle valref_h) {
+ZUSPEC_DPI_EXPORT uint64_t zuspec_ValRef_get_uint64(chandle valref_h) {
     vsc::dm::ValRef *valref = reinterpret_cast<vsc::dm::ValRef *>(valref_h);
     vsc::dm::ValRefInt valref_i(*valref);
     return valref_i.get_val_u();
 }
 
-extern "C" int64_t zuspec_ValRef_get_int64(chandle valref_h) {
+ZUSPEC_DPI_EXPORT int64_t zuspec_ValRef_get_int64(chandle valref_h) {
     vsc::dm::ValRef *valref = reinterpret_cast<vsc::dm::ValRef *>(valref_h);
     vsc::dm::ValRefInt valref_i(*valref);
     return valref_i.get_val_s();
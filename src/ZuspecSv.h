@@ -19,17 +19,29 @@
  *     Author: 
  */
 #pragma once
+#include <atomic>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include "dmgr/IDebugMgr.h"
+#include "CovDb.h"
+#include "Model.h"
+#include "SolutionTable.h"
+#include "SparseMemBackend.h"
+#include "StatsShm.h"
+#include "TxnRecorder.h"
 #include "vsc/solvers/IFactory.h"
 #include "vsc/solvers/IRandState.h"
 #include "zsp/arl/dm/IContext.h"
+#include "zsp/arl/eval/IEvalBackend.h"
 
 namespace zsp {
 namespace sv {
 
+class Actor;
 
 class ZuspecSv;
 using ZuspecSvUP=std::unique_ptr<ZuspecSv>;
@@ -44,29 +56,168 @@ public:
         bool                load,
         bool                debug);
 
+    /**
+     * Loads the default model
+     */
     bool ensureLoaded();
 
+    /**
+     * Creates a named model. Returns null if the name is already in use
+     */
+    Model *mkModel(
+        const std::string               &name,
+        const std::string               &pss_files);
+
+    Model *findModel(const std::string &name) const;
+
+    Model *getDefaultModel() const {
+        return m_default;
+    }
+
     dmgr::IDebugMgr *getDebugMgr() const {
         return m_dmgr;
     }
 
     arl::dm::IContext *ctxt() const {
-        return m_ctxt.get();
+        return (m_default)?m_default->ctxt():0;
+    }
+
+    /**
+     * Allocates the next actor id
+     */
+    int32_t nextActorId() {
+        return m_next_actor_id.fetch_add(1, std::memory_order_relaxed);
     }
 
+    /**
+     * Creates an actor for the named component and root action, loading
+     * the model first if needed. A null model selects the default model.
+     * Returns null on error
+     */
+    Actor *mkActor(
+        Model                           *model,
+        const std::string               &seed,
+        const std::string               &comp_t,
+        const std::string               &action_t,
+        arl::eval::IEvalBackend         *backend);
+
+    void addActor(Actor *actor);
+
+    /**
+     * Enables journaling, required to checkpoint, for actors created
+     * after this call. Not compatible with coverage feedback
+     */
+    bool enableCheckpoint();
+
+    /**
+     * Shares a solution table for the named type between all actors of
+     * a model, so that what one actor learns serves the others. Each 
+     * actor's results then depend on the progress of the others, and are
+     * not reproducible from its seed. When checkpointing is enabled, each
+     * actor gets its own table instead, so that a checkpoint replays 
+     * faithfully. As with per-actor tables, only self-contained solves 
+     * are tabulated: types holding references to per-actor state (comp, 
+     * pool or resource handles) are always solved. Applies to actors 
+     * created after this call
+     */
+    void addSolutionTable(
+        const std::string               &type,
+        uint32_t                        max_size,
+        uint32_t                        saturate);
+
+    /**
+     * Samples automatic action coverage into a database file at 'path',
+     * for actors created after this call
+     */
+    bool enableCoverage(const std::string &path);
+
+    /**
+     * Biases solves toward unhit coverage bins, keeping the best of 'k'
+     * solutions. A non-empty 'prior' names a merged database from earlier
+     * runs whose counts are also considered. The chosen solutions depend
+     * on coverage counts that a journal does not capture, so this can't
+     * be combined with checkpointing
+     */
+    bool enableCoverageFeedback(uint32_t k, const std::string &prior);
+
+    /**
+     * Attaches a sparse memory, shared by actors created after this call,
+     * that serves ("functional") or checks ("shadow") addr_reg_pkg 
+     * memory reads and writes
+     */
+    bool enableMem(const std::string &mode);
+
+    SparseMem *getMem() const {
+        return m_mem.get();
+    }
+
+    /**
+     * Collects call-latency statistics, for actors created after this call
+     */
+    void enableCallStats();
+
+    /**
+     * Sets a call timeout (see Actor::setCallTimeout) for actors created
+     * after this call. Enables call statistics
+     */
+    void setCallTimeout(const std::string &func, uint64_t timeout);
+
+    /**
+     * Reports call timeouts as fatal (see Actor::setCallTimeoutFatal) for
+     * actors created after this call
+     */
+    void setCallTimeoutFatal(bool en);
+
+    /**
+     * Records executed actions to a transaction file at 'path', for 
+     * actors created after this call
+     */
+    bool enableRecording(const std::string &path);
+
+    /**
+     * Publishes live statistics in the named POSIX shared-memory segment
+     */
+    bool enableStats(const std::string &name);
+
+    /**
+     * Emits the end-of-simulation report via zuspec_message
+     */
+    void report();
+
     static ZuspecSv *inst();
 
 private:
+    Model *newModel(
+        const std::string               &name,
+        const std::string               &pss_files);
 
 private:
     static ZuspecSvUP           m_inst;
+    static std::once_flag       m_inst_once;
     dmgr::IDebugMgr             *m_dmgr;
-    std::string                 m_pssfiles;
     bool                        m_initialized;
-    bool                        m_loaded;
+    bool                        m_checkpoint;
     vsc::solvers::IFactory      *m_solver_f;
     vsc::solvers::IRandStateUP  m_randstate_glbl;
-    arl::dm::IContextUP         m_ctxt;
+    Model                       *m_default;
+    std::map<std::string, ModelUP>  m_model_m;
+    std::vector<Actor *>        m_actors;
+    // Shared solution-table settings by type, and the tables by model
+    std::map<std::string, std::pair<uint32_t,uint32_t>>  m_table_cfg_m;
+    std::map<std::pair<Model *,std::string>, SolutionTableUP>  m_table_m;
+    StatsShmUP                  m_stats;
+    CovDbUP                     m_cov;
+    CovDbUP                     m_cov_prior;
+    uint32_t                    m_cov_bias_k;
+    TxnRecorderUP               m_txn;
+    SparseMemUP                 m_mem;
+    MemMode                     m_mem_mode;
+    bool                        m_call_stats;
+    std::map<std::string, uint64_t>     m_call_timeout_m;
+    bool                        m_call_timeout_fatal;
+    // Guards model and actor creation. Evaluation does not lock
+    mutable std::mutex          m_mutex;
+    std::atomic<int32_t>        m_next_actor_id;
 
 };
 
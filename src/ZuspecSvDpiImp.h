@@ -21,6 +21,17 @@
 #pragma once
 
 typedef void *chandle;
+
+/**
+ * Marks DPI-import implementations and C entry points. These are the only
+ * symbols exported from builds that use hidden visibility (eg zsp-sv-bundle)
+ */
+#if defined(_WIN32)
+#define ZUSPEC_DPI_EXPORT extern "C" __declspec(dllexport)
+#else
+#define ZUSPEC_DPI_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
 extern "C" void zuspec_message(const char *msg);
 extern "C" void zuspec_error(const char *msg);
 extern "C" void zuspec_fatal(const char *msg);
@@ -0,0 +1,55 @@
+/*
+ * ZuspecSvHost.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ *
+ * Implements the SV-side DPI exports for C++ hosts that drive actors 
+ * through zsp/sv/IFactory.h. Messages are routed to the factory's 
+ * message handler.
+ */
+#include <stdint.h>
+#include "zsp/sv/FactoryExt.h"
+#include "ZuspecSvDpiImp.h"
+
+extern "C" void zuspec_message(const char *msg) {
+    zsp_sv_getFactory()->emitMessage(zsp::sv::MessageLevel::Info, msg);
+}
+
+extern "C" void zuspec_error(const char *msg) {
+    zsp_sv_getFactory()->emitMessage(zsp::sv::MessageLevel::Error, msg);
+}
+
+extern "C" void zuspec_fatal(const char *msg) {
+    zsp_sv_getFactory()->emitMessage(zsp::sv::MessageLevel::Fatal, msg);
+}
+
+extern "C" void zuspec_EvalBackendProxy_emitMessage(
+    chandle     proxy_h,
+    const char *msg) {
+    zuspec_fatal("SystemVerilog backends are not available in a C++ host");
+}
+
+extern "C" void zuspec_EvalBackendProxy_callFuncReq(
+    chandle             proxy_h,
+    chandle             thread_h,
+    chandle             func_t,
+    uint32_t            is_target,
+    const chandle       params_h) {
+    zuspec_fatal("SystemVerilog backends are not available in a C++ host");
+}
+
@@ -0,0 +1,55 @@
+/**
+ * IActor.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+
+namespace zsp {
+namespace sv {
+
+class IActor {
+public:
+
+    virtual ~IActor() { }
+
+    virtual int32_t id() const = 0;
+
+    /**
+     * Runs the actor until it is blocked on outstanding calls or 
+     * complete. Returns non-zero while the actor has work outstanding
+     */
+    virtual int32_t eval() = 0;
+
+    /**
+     * Like eval(), but returns 2 once roughly 'max_us' microseconds of
+     * evaluation work have been done. Call again to resume. Applies to
+     * streamed actors: evaluation yields between iterations, and a 
+     * single iteration's context (including a single solve) runs until
+     * it blocks, so the budget may be exceeded by one step. Other 
+     * actors evaluate as eval() does, and warn once that the budget is
+     * ignored
+     */
+    virtual int32_t evalBudget(uint64_t max_us) = 0;
+
+};
+
+}
+}
+
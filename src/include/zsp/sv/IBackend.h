@@ -0,0 +1,132 @@
+/**
+ * IBackend.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stddef.h>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "zsp/sv/IFuncCall.h"
+
+namespace zsp {
+namespace sv {
+
+/**
+ * Parameter type that receives the address of an addr_handle_t
+ * parameter in a function registered with IBackend::addFunction
+ */
+struct AddrHandle {
+    uint64_t        addr;
+};
+
+using FuncHandler=std::function<void(IFuncCall *)>;
+
+namespace detail {
+
+template <class T, class Enable=void> struct FuncParam;
+
+template <class T> struct FuncParam<T, 
+    typename std::enable_if<std::is_integral<T>::value>::type> {
+    static T get(IFuncCall *call, int32_t idx) {
+        return (std::is_signed<T>::value)?
+            static_cast<T>(call->getParamS(idx)):
+            static_cast<T>(call->getParamU(idx));
+    }
+};
+
+template <> struct FuncParam<AddrHandle> {
+    static AddrHandle get(IFuncCall *call, int32_t idx) {
+        return AddrHandle{call->getParamAddr(idx)};
+    }
+};
+
+template <class R> struct FuncResult {
+    template <class F, class... P> static void invoke(IFuncCall *call, F &f, P&&... p) {
+        call->setIntResult(static_cast<int64_t>(f(std::forward<P>(p)...)));
+    }
+};
+
+template <> struct FuncResult<void> {
+    template <class F, class... P> static void invoke(IFuncCall *call, F &f, P&&... p) {
+        f(std::forward<P>(p)...);
+        call->setVoidResult();
+    }
+};
+
+template <class Sig> struct SyncFunc;
+
+template <class R, class... A> struct SyncFunc<R(A...)> {
+    template <class F, size_t... I> static void invoke(
+            IFuncCall *call, F &f, std::index_sequence<I...>) {
+        FuncResult<R>::invoke(call, f,
+            FuncParam<typename std::decay<A>::type>::get(call, I)...);
+    }
+
+    template <class F> static FuncHandler mk(F f) {
+        return [f](IFuncCall *call) mutable {
+            invoke(call, f, std::index_sequence_for<A...>());
+        };
+    }
+};
+
+}
+
+/**
+ * Backend for actors driven directly from C++. Solve and target function
+ * calls are dispatched by name to the registered handlers
+ */
+class IBackend {
+public:
+
+    virtual ~IBackend() { }
+
+    /**
+     * Registers a handler for the named (fully-qualified) function. The
+     * handler may complete the call immediately or hold the call object
+     * and complete it later, before the actor is next evaluated
+     */
+    virtual void addFuncHandler(
+        const std::string           &name,
+        const FuncHandler           &handler) = 0;
+
+    /**
+     * Registers a handler for functions without a specific handler. 
+     * Otherwise, unhandled calls are reported as errors and completed 
+     * with a zero (or void) result
+     */
+    virtual void setDefaultFuncHandler(const FuncHandler &handler) = 0;
+
+    /**
+     * Registers a typed handler that completes synchronously. For example:
+     *   backend->addFunction<uint32_t(AddrHandle)>("pkg::read32", 
+     *      [&](AddrHandle a) { return mem.read32(a.addr); });
+     */
+    template <class Sig, class F> void addFunction(
+            const std::string       &name,
+            F                       f) {
+        addFuncHandler(name, detail::SyncFunc<Sig>::mk(f));
+    }
+
+};
+
+}
+}
+
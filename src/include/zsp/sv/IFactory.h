@@ -0,0 +1,94 @@
+/**
+ * IFactory.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <functional>
+#include <string>
+#include "zsp/sv/IActor.h"
+#include "zsp/sv/IBackend.h"
+
+namespace zsp {
+namespace sv {
+
+enum class MessageLevel {
+    Info,
+    Error,
+    Fatal
+};
+
+using MessageHandler=std::function<void(MessageLevel, const std::string &)>;
+
+/**
+ * Entry point for C++ testbenches and virtual platforms that drive actors
+ * directly rather than through the SystemVerilog DPI layer. Hosts must
+ * link zsp-sv-host, which routes runtime messages to this interface
+ */
+class IFactory {
+public:
+
+    virtual ~IFactory() { }
+
+    /**
+     * Specifies the PSS file to load. Loading is deferred until the first
+     * actor is created
+     */
+    virtual bool init(
+        const std::string           &pss_files,
+        bool                        debug=false) = 0;
+
+    /**
+     * Loads the PSS files now, rather than when the first actor is 
+     * created. Returns false if loading fails
+     */
+    virtual bool load() = 0;
+
+    /**
+     * Creates a backend. The backend is owned by the factory, and serves
+     * a single actor
+     */
+    virtual IBackend *mkBackend() = 0;
+
+    /**
+     * Creates an actor. The actor is owned by the factory. Returns null
+     * on error, with the reason available from getLastError()
+     */
+    virtual IActor *mkActor(
+        const std::string           &seed,
+        const std::string           &comp_t,
+        const std::string           &action_t,
+        IBackend                    *backend) = 0;
+
+    /**
+     * Replaces the default handler, which prints to stdout. Messages 
+     * may be emitted from any thread, so the handler must be thread-safe
+     */
+    virtual void setMessageHandler(const MessageHandler &handler) = 0;
+
+    virtual void emitMessage(
+        MessageLevel                level,
+        const std::string           &msg) = 0;
+
+    virtual std::string getLastError() const = 0;
+
+};
+
+}
+}
+
@@ -0,0 +1,71 @@
+/**
+ * IFuncCall.h
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may 
+ * not use this file except in compliance with the License.  
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software 
+ * distributed under the License is distributed on an "AS IS" BASIS, 
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  
+ * See the License for the specific language governing permissions and 
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author: 
+ */
+#pragma once
+#include <stdint.h>
+#include <string>
+
+namespace zsp {
+namespace sv {
+
+/**
+ * A solve or target function call issued by an actor. The call remains
+ * outstanding until one of the set*Result methods is called. After that,
+ * the call object is released and must not be used again
+ */
+class IFuncCall {
+public:
+
+    virtual ~IFuncCall() { }
+
+    virtual const std::string &name() const = 0;
+
+    virtual bool isTarget() const = 0;
+
+    /**
+     * True when the function returns a value, and must be completed
+     * with setIntResult()
+     */
+    virtual bool hasResult() const = 0;
+
+    virtual int32_t numParams() const = 0;
+
+    virtual uint64_t getParamU(int32_t idx) const = 0;
+
+    virtual int64_t getParamS(int32_t idx) const = 0;
+
+    /**
+     * Returns the address held by an addr_handle_t parameter
+     */
+    virtual uint64_t getParamAddr(int32_t idx) const = 0;
+
+    virtual void setVoidResult() = 0;
+
+    /**
+     * Completes the call with a value sized and signed according to the
+     * function's declared return type
+     */
+    virtual void setIntResult(int64_t value) = 0;
+
+};
+
+}
+}
+
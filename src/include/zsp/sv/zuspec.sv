@@ -37,6 +37,26 @@ package zuspec;
   typedef class ValRef;
   typedef class ActorCore;
 
+  // Set when simulation time is used by the C++ side: to record executed
+  // actions (+zuspec.txn) or to time calls (+zuspec.call_stats). Time is
+  // then passed in before each evaluation step and call result
+  bit time_en = 0;
+
+  // Size, in 64-bit words, of the buffer that action start/end events
+  // are delivered through. Must be at least 64 (the largest event)
+  localparam int ACTION_EV_BUF = 1024;
+
+  // Page size of the sparse memory (+zuspec.mem), and the chunk size of 
+  // bulk transfers to and from it
+  localparam int MEM_PAGE_SIZE = 4096;
+  localparam int MEM_PAGES_BUF = 256;
+
+  function automatic void update_time();
+    if (time_en) begin
+        zuspec_setTime($time);
+    end
+  endfunction
+
   class NullBase;
     // empty class to use as base type
   endclass
@@ -62,6 +82,48 @@ package zuspec;
         `ZUSPEC_FATAL(("FATAL: zuspec::Backend::invokeFuncSolve not implemented"));
     endfunction
 
+    // Action lifecycle notifications, delivered when enabled with 
+    // ActorCore::set_action_events(). 'id' identifies the action instance
+    // within the actor. 'fields' holds the action's integer fields, in 
+    // declaration order, as solved (start) and as executed (end)
+    virtual function void actionStart(
+        longint unsigned    id,
+        string              action_t,
+        longint unsigned    fields[]);
+    endfunction
+
+    virtual function void actionEnd(
+        longint unsigned    id,
+        string              action_t,
+        longint unsigned    fields[]);
+    endfunction
+
+  endclass
+
+  // An independent PSS model. Models loaded with load_async() are 
+  // elaborated on background threads while simulation proceeds, one 
+  // model at a time
+  class Model;
+    chandle              m_hndl;
+    string               m_name;
+
+    function new(string name, string pss_files);
+        m_name = name;
+        m_hndl = zuspec_Model_new(name, pss_files);
+        if (m_hndl == null) begin
+            `ZUSPEC_FATAL(("FATAL: Failed to create model %0s", name));
+        end
+    endfunction
+
+    function void load_async();
+        zuspec_Model_loadAsync(m_hndl);
+    endfunction
+
+    // Loads the model, waiting for a background load to complete
+    function bit ensure_loaded();
+        return zuspec_Model_ensureLoaded(m_hndl);
+    endfunction
+
   endclass
 
   class ActorCore;
@@ -71,12 +133,23 @@ package zuspec;
     MethodBridge         m_method_if;
     int unsigned         m_pending_tasks = 0;
     semaphore            m_task_sem = new();
+    // Wall-clock limit (us) on a single evaluation step. 0 is unlimited
+    longint unsigned     m_eval_budget_us = 0;
+    bit                  m_async = 0;
+    bit                  m_action_events = 0;
+    bit                  m_running = 0;
+    // Wakes an idle call watchdog: a timeout was set, a target call was
+    // issued, or run() completed
+    event                m_watchdog_ev;
+    string               m_action_types[int unsigned];
+    longint unsigned     m_action_ev_buf[ACTION_EV_BUF];
 
     function new(
         string          comp_t,
         string          action_t,
         MethodBridge    method_if,        
-        string          name="");
+        string          name="",
+        Model           model=null);
         process p = process::self();
         string randstate = p.get_randstate();
         longint unsigned backend_h;
@@ -87,6 +160,7 @@ package zuspec;
         proxy2actor_m[backend_h] = this;
 
         m_hndl = zuspec_Actor_new(
+            (model != null)?model.m_hndl:null,
             randstate,
             comp_t, 
             action_t,
@@ -101,14 +175,63 @@ package zuspec;
     endfunction
 
     task run();
+        m_running = 1;
+        fork
+            call_watchdog();
+        join_none
+
+        run_steps();
+        m_running = 0;
+        // Releases an idle watchdog
+        ->m_watchdog_ev;
+    endtask
+
+    // Checks for calls outstanding past their timeout four times per 
+    // period of the shortest timeout, until run() completes. The timeout
+    // is re-read each period, so that timeouts set while running apply.
+    // With no timeout set or no target calls outstanding, the watchdog 
+    // sleeps until that changes rather than polling
+    task call_watchdog();
+        longint unsigned timeout;
+
+        while (m_running) begin
+            timeout = zuspec_Actor_getMinCallTimeout(m_hndl);
+            if (timeout == 0 || m_pending_tasks == 0) begin
+                @(m_watchdog_ev);
+            end else begin
+                #((timeout >= 4)?(timeout/4):1);
+                update_time();
+                void'(zuspec_Actor_checkCallTimeouts(m_hndl));
+            end
+        end
+    endtask
+
+    task run_steps();
         int ret = 0;
 
+        if (m_async) begin
+            run_async();
+            return;
+        end
+
         // TODO:
         do begin
-            ret = zuspec_Actor_eval(m_hndl);
+            update_time();
+            if (m_eval_budget_us != 0) begin
+                ret = zuspec_Actor_evalBudget(m_hndl, m_eval_budget_us);
+            end else begin
+                ret = zuspec_Actor_eval(m_hndl);
+            end
+
+            if (m_action_events) begin
+                deliver_action_events();
+            end
 
             `ZUSPEC_DEBUG(("ret=%0d pending_tasks=%0d", ret, m_pending_tasks));
-            if (m_pending_tasks > 0) begin
+            if (ret == 2) begin
+                // Budget exhausted. Let the simulation advance, then resume
+                eval_yield();
+            end else if (m_pending_tasks > 0) begin
                 `ZUSPEC_DEBUG(("--> wait_sem"));
                 m_task_sem.get();
                 `ZUSPEC_DEBUG(("<-- wait_sem"));
@@ -116,9 +239,219 @@ package zuspec;
                 `ZUSPEC_FATAL(("Zuspec FATAL: evaluation stalled"));
                 break;
             end
-        end while (ret == 1);
+        end while (ret != 0);
     endtask
 
+    // Evaluation runs on a worker thread while simulation time advances.
+    // The results of each step are collected by polling
+    task run_async();
+        int ret = 0;
+        int n_results;
+
+        forever begin
+            update_time();
+            zuspec_Actor_evalRequest(m_hndl);
+            while ((ret = zuspec_Actor_poll(m_hndl)) < 0) begin
+                wait_poll();
+            end
+
+            // Issue the calls made by this step. Solve functions complete
+            // during dispatch, and their results are applied next step
+            n_results = zuspec_Actor_dispatch(m_hndl);
+            if (m_action_events) begin
+                deliver_action_events();
+            end
+
+            `ZUSPEC_DEBUG(("ret=%0d pending_tasks=%0d results=%0d", 
+                ret, m_pending_tasks, n_results));
+            if (ret == 0) begin
+                break;
+            end else if (n_results > 0) begin
+                continue;
+            end else if (m_pending_tasks > 0) begin
+                m_task_sem.get();
+            end else begin
+                `ZUSPEC_FATAL(("Zuspec FATAL: evaluation stalled"));
+                break;
+            end
+        end
+    endtask
+
+    // Reports action starts and ends to the MethodBridge. Events are 
+    // queued during evaluation and delivered after each evaluation step,
+    // in batches of up to ACTION_EV_BUF words per DPI call
+    function void set_action_events(bit en=1);
+        m_action_events = en;
+        zuspec_Actor_setActionEvents(m_hndl, en);
+    endfunction
+
+    function void deliver_action_events();
+        int n, i, n_fields;
+        int unsigned type_id;
+        longint unsigned hdr;
+        longint unsigned fields[];
+
+        while ((n = zuspec_Actor_drainActionEvents(
+                m_hndl, m_action_ev_buf, ACTION_EV_BUF)) > 0) begin
+            i = 0;
+            while (i < n) begin
+                hdr = m_action_ev_buf[i];
+                type_id = hdr[61:32];
+                n_fields = hdr[31:0];
+                fields = new[n_fields];
+                for (int j=0; j<n_fields; j++) begin
+                    fields[j] = m_action_ev_buf[i+2+j];
+                end
+                if (!m_action_types.exists(type_id)) begin
+                    m_action_types[type_id] = 
+                        zuspec_Actor_getActionTypeName(m_hndl, type_id);
+                end
+                if (hdr[63:62] == 1) begin
+                    m_method_if.actionStart(
+                        m_action_ev_buf[i+1], m_action_types[type_id], fields);
+                end else begin
+                    m_method_if.actionEnd(
+                        m_action_ev_buf[i+1], m_action_types[type_id], fields);
+                end
+                i += 2 + n_fields;
+            end
+        end
+    endfunction
+
+    // Moves evaluation to a background thread, so that simulation time
+    // advances while the actor solves. Call before run()
+    function bit set_async(bit en=1);
+        if (!zuspec_Actor_setAsync(m_hndl, en)) begin
+            return 0;
+        end
+        m_async = en;
+        return 1;
+    endfunction
+
+    // Called while an asynchronous evaluation is in progress. Override to
+    // poll on a clock edge or other event
+    virtual task wait_poll();
+        #1;
+    endtask
+
+    // Limits the time spent in a single evaluation step. A streamed 
+    // actor (set_streaming) yields between iterations, spreading them
+    // across timesteps; a single solve is not interrupted. Other actors
+    // cannot yield: they run without a budget, and warn once on the 
+    // first step. Use set_async to keep simulation time advancing during
+    // heavy solves. 0 removes the limit
+    function void set_eval_budget(longint unsigned max_us);
+        m_eval_budget_us = max_us;
+    endfunction
+
+    // Called when an evaluation step exhausts its budget. Override to 
+    // resume on a clock edge or other event
+    virtual task eval_yield();
+        #1;
+    endtask
+
+    // Runs 'count' iterations (0: unbounded) of the root action in 
+    // sequence, each in its own evaluation context, with up to 'window'
+    // elaborated ahead. Memory use stays constant regardless of the
+    // number of iterations; a single iteration's activity is elaborated
+    // as a whole, so a root action containing a repeat or forever loop
+    // is rejected. Each iteration has its own component tree: component
+    // and pool state start afresh. Call before run()
+    function bit set_streaming(longint unsigned count, int window=1);
+        return zuspec_Actor_setStreaming(m_hndl, count, window);
+    endfunction
+
+    // Answers solves of the named action/struct type, which must have a
+    // small finite solution space, from a learned table of its solutions.
+    // The table is complete once 'saturate' consecutive solves find no 
+    // new solution. A few solves of a complete table still use the 
+    // solver, adding any legal solutions that learning missed.
+    // Types with more than 'max_size' solutions or holding references 
+    // (comp, pool or resource handles), and solves with inline (with) 
+    // constraints, are solved normally. Call before run()
+    function void add_solution_table(
+        string          type_name,
+        int unsigned    max_size=4096,
+        int unsigned    saturate=1024);
+        zuspec_Actor_addSolutionTable(m_hndl, type_name, max_size, saturate);
+    endfunction
+
+    // Saves the actor's state to a checkpoint file. Requires 
+    // +zuspec.checkpoint and no outstanding calls. Not supported with
+    // +zuspec.mem, since the memory contents are not saved
+    function bit save(string path);
+        return zuspec_Actor_save(m_hndl, path);
+    endfunction
+
+    // Restores a checkpoint saved by an actor of the same type. A 
+    // non-empty seed reseeds the restored actor, allowing many seeds
+    // to be run from one snapshot
+    function bit restore(string path, string seed="");
+        return zuspec_Actor_restore(m_hndl, path, seed);
+    endfunction
+
+    // Returns 0 when the library was not built with heap profiling
+    function int getHeapStats(
+        output longint unsigned alloc_bytes,
+        output longint unsigned alloc_count,
+        output longint unsigned live_bytes);
+        return zuspec_Actor_getHeapStats(
+            m_hndl, alloc_bytes, alloc_count, live_bytes);
+    endfunction
+
+    // Returns the number of action/struct types this actor has solved
+    function int getSolveStatsNumTypes();
+        return zuspec_Actor_getSolveStatsNumTypes(m_hndl);
+    endfunction
+
+    // Returns the name of the idx'th solved type and its statistics.
+    // 'vars' is the total number of variables over all solves
+    function string getSolveTypeStats(
+        int                     idx,
+        output longint unsigned count,
+        output longint unsigned time_ns,
+        output longint unsigned vars,
+        output longint unsigned failures,
+        output longint unsigned retries);
+        return zuspec_Actor_getSolveTypeStats(
+            m_hndl, idx, count, time_ns, vars, failures, retries);
+    endfunction
+
+    // Reports calls to the named function (or "*" for any function) that
+    // are outstanding for longer than 'timeout' (in units of this 
+    // package's $time). Takes effect for calls made after this call, 
+    // including while run() is active
+    function void set_call_timeout(string func_name, longint unsigned timeout);
+        time_en = 1;
+        zuspec_Actor_setCallTimeout(m_hndl, func_name, timeout);
+        ->m_watchdog_ev;
+    endfunction
+
+    // Reports calls that exceed their timeout with $fatal rather than 
+    // $error, so that a hung call ends the simulation
+    function void set_call_timeout_fatal(bit en=1);
+        zuspec_Actor_setCallTimeoutFatal(m_hndl, en);
+    endfunction
+
+    // Returns the number of functions this actor has called
+    function int getCallStatsNumFuncs();
+        return zuspec_Actor_getCallStatsNumFuncs(m_hndl);
+    endfunction
+
+    // Returns the name of the idx'th called function and its latency 
+    // percentiles, from dispatch to result in units of $time
+    function string getCallStats(
+        int                     idx,
+        output longint unsigned count,
+        output longint unsigned p50,
+        output longint unsigned p90,
+        output longint unsigned p99,
+        output longint unsigned max,
+        output longint unsigned timeouts);
+        return zuspec_Actor_getCallStats(
+            m_hndl, idx, count, p50, p90, p99, max, timeouts);
+    endfunction
+
     function int registerFunctionId(string name, int id);
         return zuspec_Actor_registerFunctionId(m_hndl, name, id);
     endfunction
@@ -136,6 +469,9 @@ package zuspec;
         end else begin
             if (is_target) begin
                 m_pending_tasks += 1;
+                if (m_pending_tasks == 1) begin
+                    ->m_watchdog_ev;
+                end
                 fork
                     begin
                         automatic int l_func_id = func_id;
@@ -190,9 +526,11 @@ package zuspec;
   endclass
 
   class EvalThread;
+    chandle         m_actor_h;
     chandle         m_hndl;
 
-    function new(chandle hndl);
+    function new(chandle actor_h, chandle hndl);
+        m_actor_h = actor_h;
         m_hndl = hndl;
     endfunction
 
@@ -201,14 +539,16 @@ package zuspec;
     endfunction
 
     function void setVoidResult();
-        zuspec_EvalThread_setVoidResult(m_hndl);
+        update_time();
+        zuspec_EvalThread_setVoidResult(m_actor_h, m_hndl);
     endfunction
 
     function void setIntResult(
         longint value,
         bit     is_signed,
         int     width);
-        zuspec_EvalThread_setIntResult(m_hndl, value, int'(is_signed), width);
+        update_time();
+        zuspec_EvalThread_setIntResult(m_actor_h, m_hndl, value, int'(is_signed), width);
     endfunction
 
     function longint unsigned getAddrHandleValue(ValRef val);
@@ -222,6 +562,13 @@ package zuspec;
     automatic string pss_files;
     automatic int load = 0;
     automatic int debug = 0;
+    automatic string stats;
+    automatic string cov;
+    automatic string cov_prior;
+    automatic int cov_bias = 0;
+    automatic string txn;
+    automatic string mem;
+    automatic longint unsigned call_timeout;
     automatic process p = process::self();
 
     `ZUSPEC_DEBUG(("randstate: %0s", p.get_randstate()));
@@ -236,9 +583,149 @@ package zuspec;
     if (zuspec_init(pss_files, load, debug) != 1) begin
         `ZUSPEC_FATAL(("FATAL: Failed to initialize Zuspec package"));
         return 0;
-    end else begin
-        return 1;
     end
+
+    // +zuspec.checkpoint journals actors so they can be saved/restored
+    if ($test$plusargs("zuspec.checkpoint")) begin
+        void'(zuspec_enableCheckpoint());
+    end
+
+    // +zuspec.stats publishes live statistics in /zsp-sv-<pid>, 
+    // +zuspec.stats=<name> in the named segment
+    if ($test$plusargs("zuspec.stats")) begin
+        void'($value$plusargs("zuspec.stats=%s", stats));
+        void'(zuspec_enableStats(stats));
+    end
+
+    // +zuspec.cov=<path> samples automatic action coverage into a 
+    // database, merged across runs with zsp-sv-covdb
+    if ($value$plusargs("zuspec.cov=%s", cov)) begin
+        void'(zuspec_enableCoverage(cov));
+
+        // +zuspec.cov_bias=<K> keeps the best of K solutions for coverage,
+        // +zuspec.cov_prior=<path> adds the counts of a merged database.
+        // Not available with +zuspec.checkpoint, since replay can't 
+        // reproduce choices made from live coverage counts
+        if ($value$plusargs("zuspec.cov_bias=%d", cov_bias)) begin
+            void'($value$plusargs("zuspec.cov_prior=%s", cov_prior));
+            void'(zuspec_enableCoverageFeedback(cov_bias, cov_prior));
+        end
+    end
+
+    // +zuspec.mem=functional serves addr_reg_pkg memory reads/writes
+    // from a sparse memory without calling the target, and 
+    // +zuspec.mem=shadow mirrors them there to check read data
+    if ($value$plusargs("zuspec.mem=%s", mem)) begin
+        void'(zuspec_enableMem(mem));
+    end
+
+    // +zuspec.txn=<path> records executed actions, with their solved 
+    // fields and start/end times, for analysis with 'python -m zsp_sv txn'
+    if ($value$plusargs("zuspec.txn=%s", txn)) begin
+        time_en |= zuspec_enableRecording(txn);
+    end
+
+    // +zuspec.call_stats collects call-latency percentiles, and 
+    // +zuspec.call_timeout=<t> also reports calls outstanding for longer
+    // than <t> (in units of this package's $time). With 
+    // +zuspec.call_timeout_fatal, such calls are fatal
+    if ($test$plusargs("zuspec.call_stats")) begin
+        zuspec_enableCallStats();
+        time_en = 1;
+    end
+    if ($value$plusargs("zuspec.call_timeout=%d", call_timeout)) begin
+        zuspec_setCallTimeout("*", call_timeout);
+        time_en = 1;
+    end
+    if ($test$plusargs("zuspec.call_timeout_fatal")) begin
+        zuspec_setCallTimeoutFatal(1);
+    end
+
+    return 1;
+  endfunction
+
+  // Shares a solution table (see ActorCore::add_solution_table) for the
+  // named type between all actors of a model, so solutions learned by one
+  // actor serve the others. An actor's results then depend on the 
+  // progress of the others, and are not reproducible from its seed. With
+  // +zuspec.checkpoint, each actor gets its own table instead. Types that
+  // hold references to an actor's component tree are never tabulated. 
+  // Applies to actors created after the call
+  function void add_shared_solution_table(
+    string          type_name,
+    int unsigned    max_size=4096,
+    int unsigned    saturate=1024);
+    zuspec_addSolutionTable(type_name, max_size, saturate);
+  endfunction
+
+  // Copies 'data' into the sparse memory at 'addr'. Use to preload 
+  // memory contents before actors run
+  function automatic void mem_write(longint unsigned addr, byte unsigned data[]);
+    byte unsigned buf[MEM_PAGE_SIZE];
+    int unsigned off = 0, n;
+
+    while (off < data.size()) begin
+        n = data.size() - off;
+        if (n > MEM_PAGE_SIZE) begin
+            n = MEM_PAGE_SIZE;
+        end
+        for (int i=0; i<n; i++) begin
+            buf[i] = data[off+i];
+        end
+        zuspec_memWrite(addr+off, buf, n);
+        off += n;
+    end
+  endfunction
+
+  // Reads 'n' bytes from the sparse memory at 'addr'. Unwritten bytes 
+  // read as 0. Returns 1 if all bytes had been written
+  function automatic bit mem_read(
+    longint unsigned    addr,
+    int unsigned        n,
+    output byte unsigned data[]);
+    byte unsigned buf[MEM_PAGE_SIZE];
+    int unsigned off = 0, sz;
+    bit valid = 1;
+
+    data = new[n];
+    while (off < n) begin
+        sz = n - off;
+        if (sz > MEM_PAGE_SIZE) begin
+            sz = MEM_PAGE_SIZE;
+        end
+        valid &= zuspec_memRead(addr+off, buf, sz);
+        for (int i=0; i<sz; i++) begin
+            data[off+i] = buf[i];
+        end
+        off += sz;
+    end
+    return valid;
+  endfunction
+
+  // Returns the base addresses of the sparse memory's allocated pages, in
+  // address order. With mem_read, copies memory contents back to SV
+  function automatic void mem_pages(output longint unsigned addrs[$]);
+    longint unsigned buf[MEM_PAGES_BUF];
+    longint unsigned from = 0;
+    int n;
+
+    addrs.delete();
+    while ((n = zuspec_memGetPages(buf, from, MEM_PAGES_BUF)) > 0) begin
+        for (int i=0; i<n; i++) begin
+            addrs.push_back(buf[i]);
+        end
+        // A short chunk ends the walk, as does the top page (the next
+        // address wraps to 0)
+        from = buf[n-1] + MEM_PAGE_SIZE;
+        if (n < MEM_PAGES_BUF || from == 0) begin
+            break;
+        end
+    end
+  endfunction
+
+  // Emits the end-of-simulation report. Call from a final block
+  function void report();
+    zuspec_report();
   endfunction
 
   function zuspec_message(string msg);
@@ -262,14 +749,130 @@ package zuspec;
    ******************************************************************/
 
   import "DPI-C" context function void zuspec_enableDebug(int en);
+  import "DPI-C" context function void zuspec_report();
+  import "DPI-C" context function int zuspec_enableStats(string name);
+  import "DPI-C" context function int zuspec_enableCoverage(string path);
+  import "DPI-C" context function int zuspec_enableRecording(string path);
+  import "DPI-C" context function int zuspec_enableMem(string mode);
+  import "DPI-C" function void zuspec_memWrite(
+    longint unsigned    addr,
+    input byte unsigned data[MEM_PAGE_SIZE],
+    int unsigned        n);
+  import "DPI-C" function int zuspec_memRead(
+    longint unsigned    addr,
+    output byte unsigned data[MEM_PAGE_SIZE],
+    int unsigned        n);
+  import "DPI-C" function int zuspec_memGetPages(
+    output longint unsigned addrs[MEM_PAGES_BUF],
+    longint unsigned    from,
+    int unsigned        max);
+  import "DPI-C" function void zuspec_setTime(longint unsigned time_v);
+  import "DPI-C" context function int zuspec_enableCoverageFeedback(
+    int unsigned        k,
+    string              prior);
+
+  import "DPI-C" context function chandle zuspec_Model_new(
+    string              name,
+    string              pss_files);
+  import "DPI-C" context function void zuspec_Model_loadAsync(
+    chandle             model_h);
+  import "DPI-C" context function int zuspec_Model_ensureLoaded(
+    chandle             model_h);
 
   import "DPI-C" context function chandle zuspec_Actor_new(
+    chandle             model_h,
     string              randstate,
     string              comp_t,
     string              action_t,
     longint unsigned    backend_h);
   import "DPI-C" context function int zuspec_Actor_eval(
     chandle             actor_h);
+  import "DPI-C" context function int zuspec_Actor_evalBudget(
+    chandle             actor_h,
+    longint unsigned    max_us);
+  import "DPI-C" context function int zuspec_Actor_setAsync(
+    chandle             actor_h,
+    int                 en);
+  import "DPI-C" context function void zuspec_Actor_evalRequest(
+    chandle             actor_h);
+  import "DPI-C" function int zuspec_Actor_poll(
+    chandle             actor_h);
+  import "DPI-C" context function int zuspec_Actor_dispatch(
+    chandle             actor_h);
+  import "DPI-C" context function void zuspec_Actor_setActionEvents(
+    chandle             actor_h,
+    int                 en);
+  import "DPI-C" function int zuspec_Actor_drainActionEvents(
+    chandle             actor_h,
+    output longint unsigned buf[ACTION_EV_BUF],
+    int unsigned        max);
+  import "DPI-C" context function string zuspec_Actor_getActionTypeName(
+    chandle             actor_h,
+    int unsigned        id);
+  import "DPI-C" context function int zuspec_Actor_setStreaming(
+    chandle             actor_h,
+    longint unsigned    count,
+    int                 window);
+  import "DPI-C" context function int zuspec_enableCheckpoint();
+  import "DPI-C" context function int zuspec_Actor_save(
+    chandle             actor_h,
+    string              path);
+  import "DPI-C" context function int zuspec_Actor_restore(
+    chandle             actor_h,
+    string              path,
+    string              seed);
+  import "DPI-C" context function void zuspec_addSolutionTable(
+    string              type_name,
+    int unsigned        max_size,
+    int unsigned        saturate);
+  import "DPI-C" context function void zuspec_Actor_addSolutionTable(
+    chandle             actor_h,
+    string              type_name,
+    int unsigned        max_size,
+    int unsigned        saturate);
+  import "DPI-C" context function int zuspec_Actor_getSolveStatsNumTypes(
+    chandle             actor_h);
+  import "DPI-C" context function string zuspec_Actor_getSolveTypeStats(
+    chandle                 actor_h,
+    int                     idx,
+    output longint unsigned count,
+    output longint unsigned time_ns,
+    output longint unsigned vars,
+    output longint unsigned failures,
+    output longint unsigned retries);
+  import "DPI-C" context function void zuspec_enableCallStats();
+  import "DPI-C" context function void zuspec_setCallTimeout(
+    string                  func_name,
+    longint unsigned        timeout);
+  import "DPI-C" context function void zuspec_setCallTimeoutFatal(
+    int                     en);
+  import "DPI-C" context function void zuspec_Actor_setCallTimeout(
+    chandle                 actor_h,
+    string                  func_name,
+    longint unsigned        timeout);
+  import "DPI-C" context function void zuspec_Actor_setCallTimeoutFatal(
+    chandle                 actor_h,
+    int                     en);
+  import "DPI-C" context function longint unsigned zuspec_Actor_getMinCallTimeout(
+    chandle                 actor_h);
+  import "DPI-C" context function int zuspec_Actor_checkCallTimeouts(
+    chandle                 actor_h);
+  import "DPI-C" context function int zuspec_Actor_getCallStatsNumFuncs(
+    chandle                 actor_h);
+  import "DPI-C" context function string zuspec_Actor_getCallStats(
+    chandle                 actor_h,
+    int                     idx,
+    output longint unsigned count,
+    output longint unsigned p50,
+    output longint unsigned p90,
+    output longint unsigned p99,
+    output longint unsigned max,
+    output longint unsigned timeouts);
+  import "DPI-C" context function int zuspec_Actor_getHeapStats(
+    chandle             actor_h,
+    output longint unsigned alloc_bytes,
+    output longint unsigned alloc_count,
+    output longint unsigned live_bytes);
   import "DPI-C" context function int unsigned zuspec_Actor_registerFunctionId(
     chandle             actor_h,
     string              name,
@@ -305,7 +908,7 @@ package zuspec;
     int unsigned        is_target,
     chandle             params_h);
     automatic ActorCore   actor = ActorCore::proxy2actor_m[proxy_h];
-    automatic EvalThread  thread = new(thread_h);
+    automatic EvalThread  thread = new(actor.m_hndl, thread_h);
     automatic ValRef params[];
     
     params = new[zuspec_ValRefList_size(params_h)];
@@ -327,6 +930,7 @@ package zuspec;
   export "DPI-C" function zuspec_EvalBackendProxy_emitMessage;
 
   import "DPI-C" context function void zuspec_EvalThread_setVoidResult(
+    chandle             actor_h,
     chandle             thread_h
   );
 
@@ -335,6 +939,7 @@ package zuspec;
     chandle             valref_h);
 
   import "DPI-C" context function void zuspec_EvalThread_setIntResult(
+    chandle             actor_h,
     chandle             thread_h,
     longint             value,
     int                 is_signed,
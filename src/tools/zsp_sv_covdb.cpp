@@ -0,0 +1,193 @@
+/*
+ * zsp_sv_covdb.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ *
+ * Merges and reports coverage databases written by zsp-sv 
+ * (+zuspec.cov=<path>). Databases are memory-mapped, and merging matches
+ * items by name and sums their counters.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CovDb.h"
+
+using namespace zsp::sv;
+
+static void usage() {
+    fprintf(stdout,
+        "Usage: zsp-sv-covdb merge -o <out> <db> [<db> ...]\n"
+        "       zsp-sv-covdb report [-v] <db>\n");
+    exit(1);
+}
+
+struct MergeItem {
+    std::string                 name;
+    uint32_t                    n_bins;
+    uint64_t                    bin_base;
+};
+
+static int merge(const std::string &out, const std::vector<std::string> &inputs) {
+    std::vector<CovDbUP> dbs;
+    std::vector<MergeItem> items;
+    std::unordered_map<std::string, uint32_t> item_m;
+    uint64_t n_bins = 0, names_size = 0, runs = 0;
+    std::string err;
+
+    for (std::vector<std::string>::const_iterator
+        it=inputs.begin();
+        it!=inputs.end(); it++) {
+        CovDb *db = CovDb::open(*it, false, err);
+        if (!db) {
+            fprintf(stderr, "Error: %s\n", err.c_str());
+            return 1;
+        }
+        dbs.push_back(CovDbUP(db));
+        runs += db->header()->runs;
+
+        for (uint32_t i=0; i<db->header()->n_items; i++) {
+            std::string name = db->itemName(i);
+            std::unordered_map<std::string, uint32_t>::const_iterator i_it;
+            if ((i_it=item_m.find(name)) == item_m.end()) {
+                item_m.insert({name, items.size()});
+                items.push_back({name, db->item(i).n_bins, n_bins});
+                n_bins += db->item(i).n_bins;
+                names_size += name.size();
+            } else if (items.at(i_it->second).n_bins != db->item(i).n_bins) {
+                fprintf(stderr, "Error: %s: item %s has %u bins, expected %u\n",
+                    it->c_str(), name.c_str(), db->item(i).n_bins, 
+                    items.at(i_it->second).n_bins);
+                return 1;
+            }
+        }
+    }
+
+    // Written alongside and renamed, so an input may also be the output
+    std::string tmp = out + ".tmp";
+    CovDbUP out_db(CovDb::create(tmp, items.size(), n_bins, names_size));
+    if (!out_db) {
+        fprintf(stderr, "Error: failed to create %s\n", tmp.c_str());
+        return 1;
+    }
+
+    for (std::vector<MergeItem>::const_iterator
+        it=items.begin();
+        it!=items.end(); it++) {
+        out_db->addItem(it->name, it->n_bins);
+    }
+
+    for (std::vector<CovDbUP>::const_iterator
+        it=dbs.begin();
+        it!=dbs.end(); it++) {
+        const CovDb *db = it->get();
+        for (uint32_t i=0; i<db->header()->n_items; i++) {
+            const CovDbItem &src = db->item(i);
+            uint64_t dst = items.at(item_m.at(db->itemName(i))).bin_base;
+            for (uint32_t b=0; b<src.n_bins; b++) {
+                uint64_t count = db->count(src.bin_base+b);
+                if (count) {
+                    out_db->add(dst+b, count);
+                }
+            }
+        }
+    }
+    out_db->setRuns(runs);
+    out_db.reset();
+    dbs.clear();
+
+    if (rename(tmp.c_str(), out.c_str()) != 0) {
+        fprintf(stderr, "Error: failed to rename %s to %s\n", tmp.c_str(), out.c_str());
+        return 1;
+    }
+
+    fprintf(stdout, "Merged %u databases (%llu runs): %u items, %llu bins\n",
+        (uint32_t)inputs.size(), (unsigned long long)runs,
+        (uint32_t)items.size(), (unsigned long long)n_bins);
+
+    return 0;
+}
+
+static int report(const std::string &path, bool verbose) {
+    std::string err;
+    CovDbUP db(CovDb::open(path, false, err));
+    uint64_t n_hit = 0;
+
+    if (!db) {
+        fprintf(stderr, "Error: %s\n", err.c_str());
+        return 1;
+    }
+
+    for (uint32_t i=0; i<db->header()->n_items; i++) {
+        const CovDbItem &item = db->item(i);
+        uint32_t hit = db->numHit(i);
+        n_hit += hit;
+        fprintf(stdout, "%-48s %5u/%-5u %5.1f%%\n",
+            db->itemName(i).c_str(), hit, item.n_bins, 
+            (100.0*hit)/item.n_bins);
+        if (verbose) {
+            for (uint32_t b=0; b<item.n_bins; b++) {
+                fprintf(stdout, "    [%2u] %llu\n", b,
+                    (unsigned long long)db->count(item.bin_base+b));
+            }
+        }
+    }
+
+    fprintf(stdout, "Total: %llu/%llu bins hit (%.1f%%) over %llu runs\n",
+        (unsigned long long)n_hit,
+        (unsigned long long)db->header()->n_bins,
+        (db->header()->n_bins)?(100.0*n_hit)/db->header()->n_bins:0.0,
+        (unsigned long long)db->header()->runs);
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> inputs;
+    std::string out;
+    bool verbose = false;
+
+    if (argc < 2) {
+        usage();
+    }
+
+    for (int i=2; i<argc; i++) {
+        if (!strcmp(argv[i], "-o") && i+1 < argc) {
+            out = argv[++i];
+        } else if (!strcmp(argv[i], "-v")) {
+            verbose = true;
+        } else if (argv[i][0] == '-') {
+            usage();
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+
+    if (!strcmp(argv[1], "merge") && out != "" && inputs.size()) {
+        return merge(out, inputs);
+    } else if (!strcmp(argv[1], "report") && inputs.size() == 1) {
+        return report(inputs.at(0), verbose);
+    } else {
+        usage();
+    }
+
+    return 1;
+}
+
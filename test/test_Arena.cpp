@@ -0,0 +1,159 @@
+/*
+ * test_Arena.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "Arena.h"
+
+using namespace zsp::sv;
+
+// Appends its id to a shared log when destroyed
+class Tracked {
+public:
+    Tracked(std::vector<int> *log, int id) : m_log(log), m_id(id) { }
+
+    Tracked(const Tracked &o) : m_log(o.m_log), m_id(o.m_id + 100) { }
+
+    ~Tracked() {
+        m_log->push_back(m_id);
+    }
+
+private:
+    std::vector<int>            *m_log;
+    int                         m_id;
+};
+
+TEST(Arena, alignment) {
+    Arena arena(256);
+
+    for (size_t align=1; align<=128; align*=2) {
+        arena.alloc(1, 1);
+        void *p = arena.alloc(8, align);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % align, 0U) << "align=" << align;
+    }
+
+    // Over-aligned requests that start a new block
+    for (uint32_t i=0; i<8; i++) {
+        void *p = arena.alloc(200, 128);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % 128, 0U);
+    }
+}
+
+TEST(Arena, used) {
+    Arena arena(1024);
+
+    ASSERT_EQ(arena.used(), 0U);
+    arena.alloc(100, 1);
+    arena.alloc(50, 1);
+    ASSERT_EQ(arena.used(), 150U);
+
+    // Spilling into a second block counts both blocks
+    arena.alloc(1000, 1);
+    ASSERT_EQ(arena.used(), 1150U);
+
+    arena.reset();
+    ASSERT_EQ(arena.used(), 0U);
+}
+
+TEST(Arena, reuse) {
+    Arena arena(1024);
+    std::vector<void *> first;
+
+    for (uint32_t i=0; i<64; i++) {
+        first.push_back(arena.alloc(48));
+    }
+    size_t capacity = arena.capacity();
+    ASSERT_GT(capacity, 1024U);
+
+    // The same sequence after a reset is served from the retained
+    // blocks, at the same addresses
+    for (uint32_t pass=0; pass<4; pass++) {
+        arena.reset();
+        for (uint32_t i=0; i<64; i++) {
+            ASSERT_EQ(arena.alloc(48), first[i]);
+        }
+        ASSERT_EQ(arena.capacity(), capacity);
+    }
+}
+
+TEST(Arena, oversize) {
+    Arena arena(256);
+
+    arena.alloc(16);
+    char *p = reinterpret_cast<char *>(arena.alloc(4096));
+    ASSERT_GE(arena.capacity(), 256U + 4096U);
+
+    // The whole request is usable
+    for (uint32_t i=0; i<4096; i++) {
+        p[i] = static_cast<char>(i);
+    }
+
+    // Repeating the sequence reuses the dedicated block
+    size_t capacity = arena.capacity();
+    arena.reset();
+    arena.alloc(16);
+    arena.alloc(4096);
+    ASSERT_EQ(arena.capacity(), capacity);
+}
+
+TEST(Arena, finalizers) {
+    std::vector<int> log;
+    Arena arena;
+
+    arena.mk<Tracked>(&log, 1);
+    arena.mk<Tracked>(&log, 2);
+    arena.mk<std::string>("not tracked, but destroyed");
+    ASSERT_TRUE(log.empty());
+
+    arena.reset();
+    ASSERT_EQ(log, (std::vector<int>{2, 1}));
+
+    // Finalizers run once
+    arena.reset();
+    ASSERT_EQ(log.size(), 2U);
+}
+
+TEST(Arena, mkArray) {
+    std::vector<int> log;
+    const uint64_t vals[] = {1, 2, 3, 4};
+
+    {
+        Arena arena;
+        uint64_t *a = arena.mkArray<uint64_t>(4, vals);
+        ASSERT_NE(a, vals);
+        ASSERT_EQ(a[0], 1U);
+        ASSERT_EQ(a[3], 4U);
+
+        // An empty array is valid and has no finalizer
+        arena.mkArray<Tracked>(0, 0);
+
+        Tracked src[] = {{&log, 1}, {&log, 2}};
+        log.clear();
+        arena.mkArray<Tracked>(2, src);
+        ASSERT_TRUE(log.empty());
+    }
+
+    // The sources go out of scope first, then the arena's destructor runs
+    // its outstanding finalizers. Array elements are destroyed in reverse
+    ASSERT_EQ(log, (std::vector<int>{2, 1, 102, 101}));
+}
+
@@ -0,0 +1,108 @@
+/*
+ * test_AsyncEval.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "zsp/arl/eval/impl/EvalBackendBase.h"
+#include "zsp/sv/FactoryExt.h"
+#include "AsyncEval.h"
+
+using namespace zsp;
+using namespace zsp::sv;
+
+// Records dispatched calls and messages. Each call posts 'n_errors' 
+// errors back to the AsyncEval, as the actor does when a call is issued
+// on a thread whose previous call is still open
+class DispatchTarget : public virtual arl::eval::EvalBackendBase {
+public:
+    DispatchTarget() : m_async(0), m_n_errors(0), m_n_calls(0) { }
+
+    virtual void callFuncReq(
+            arl::eval::IEvalThread              *thread,
+            arl::dm::IDataTypeFunction          *func_t,
+            const std::vector<vsc::dm::ValRef>  &params) override {
+        m_n_calls++;
+        for (uint32_t i=0; i<m_n_errors; i++) {
+            m_async->postError("error " + std::to_string(i));
+        }
+    }
+
+    virtual void emitMessage(const std::string &msg) override {
+        m_msgs.push_back(msg);
+    }
+
+    AsyncEval                   *m_async;
+    uint32_t                    m_n_errors;
+    uint32_t                    m_n_calls;
+    std::vector<std::string>    m_msgs;
+};
+
+class AsyncEvalTest : public ::testing::Test {
+protected:
+    virtual void SetUp() override {
+        zsp_sv_getFactory()->setMessageHandler(
+            [this](MessageLevel level, const std::string &msg) {
+                if (level == MessageLevel::Error) {
+                    m_errors.push_back(msg);
+                }
+            });
+    }
+
+    virtual void TearDown() override {
+        zsp_sv_getFactory()->setMessageHandler(MessageHandler());
+    }
+
+    std::vector<std::string>    m_errors;
+};
+
+TEST_F(AsyncEvalTest, errorPostedDuringDispatch) {
+    DispatchTarget target;
+    // The worker only touches the actor when asked to evaluate
+    AsyncEval async(0, &target);
+    int func_v, thread_v;
+    arl::dm::IDataTypeFunction *func_t = 
+        reinterpret_cast<arl::dm::IDataTypeFunction *>(&func_v);
+    arl::eval::IEvalThread *thread = 
+        reinterpret_cast<arl::eval::IEvalThread *>(&thread_v);
+
+    target.m_async = &async;
+    target.m_n_errors = 64;
+
+    // Enough errors are posted by each call to grow the request list
+    async.callFuncReq(thread, func_t, std::vector<vsc::dm::ValRef>());
+    async.emitMessage("msg");
+    async.callFuncReq(thread, func_t, std::vector<vsc::dm::ValRef>());
+
+    ASSERT_EQ(async.dispatch(), 0);
+    ASSERT_EQ(target.m_n_calls, 2U);
+    ASSERT_EQ(target.m_msgs, std::vector<std::string>{"msg"});
+
+    // Errors posted during dispatch are reported by the same dispatch
+    ASSERT_EQ(m_errors.size(), 128U);
+    ASSERT_EQ(m_errors.front(), "error 0");
+    ASSERT_EQ(m_errors.back(), "error 63");
+
+    // Nothing is left to dispatch
+    m_errors.clear();
+    ASSERT_EQ(async.dispatch(), 0);
+    ASSERT_EQ(m_errors.size(), 0U);
+    ASSERT_EQ(target.m_n_calls, 2U);
+}
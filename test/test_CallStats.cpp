@@ -0,0 +1,127 @@
+/*
+ * test_CallStats.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdint.h>
+#include "gtest/gtest.h"
+#include "CallStats.h"
+
+using namespace zsp::sv;
+
+TEST(CallStats, bucketSmall) {
+    // Values below 1<<SUB_BITS have a bucket each
+    for (uint64_t v=0; v<4; v++) {
+        ASSERT_EQ(CallStats::bucket(v), v);
+        ASSERT_EQ(CallStats::bucketMax(v), v);
+    }
+
+    // Then four buckets per power of two
+    ASSERT_EQ(CallStats::bucket(4), 4U);
+    ASSERT_EQ(CallStats::bucket(7), 7U);
+    ASSERT_EQ(CallStats::bucket(8), 8U);
+    ASSERT_EQ(CallStats::bucket(9), 8U);
+    ASSERT_EQ(CallStats::bucket(10), 9U);
+    ASSERT_EQ(CallStats::bucket(15), 11U);
+    ASSERT_EQ(CallStats::bucket(16), 12U);
+    ASSERT_EQ(CallStats::bucketMax(8), 9U);
+    ASSERT_EQ(CallStats::bucketMax(11), 15U);
+}
+
+TEST(CallStats, bucketBounds) {
+    // Each bucket's range ends where the next one's starts, and every
+    // value lies within its bucket. Checked around each power of two
+    uint32_t n_buckets = CallStats::N_BUCKETS;
+    for (uint32_t msb=2; msb<64; msb++) {
+        uint64_t p = 1ULL << msb;
+        uint64_t vals[] = {p-1, p, p+1, p + (p >> 2), p | (p-1)};
+        for (uint32_t i=0; i<sizeof(vals)/sizeof(vals[0]); i++) {
+            uint32_t b = CallStats::bucket(vals[i]);
+            ASSERT_LT(b, n_buckets);
+            ASSERT_LE(vals[i], CallStats::bucketMax(b)) << "v=" << vals[i];
+            ASSERT_GT(vals[i], CallStats::bucketMax(b-1)) << "v=" << vals[i];
+        }
+    }
+}
+
+TEST(CallStats, bucketTop) {
+    // The top power of two (msb=63) fits, and its last bucket ends at
+    // the largest value without overflowing
+    uint64_t top = 1ULL << 63;
+    ASSERT_EQ(CallStats::bucket(top), 248U);
+    ASSERT_EQ(CallStats::bucket(UINT64_MAX), 251U);
+    ASSERT_EQ(CallStats::bucketMax(251), UINT64_MAX);
+    ASSERT_EQ(CallStats::bucketMax(247), top-1);
+
+    CallStats stats;
+    stats.record(UINT64_MAX);
+    ASSERT_EQ(stats.buckets[251], 1U);
+    ASSERT_EQ(stats.percentile(50), UINT64_MAX);
+}
+
+TEST(CallStats, record) {
+    CallStats stats;
+
+    stats.record(10);
+    stats.record(20);
+    stats.record(0);
+    ASSERT_EQ(stats.count, 3U);
+    ASSERT_EQ(stats.total, 30U);
+    ASSERT_EQ(stats.max, 20U);
+    ASSERT_EQ(stats.buckets[CallStats::bucket(10)], 1U);
+    ASSERT_EQ(stats.buckets[0], 1U);
+}
+
+TEST(CallStats, percentile) {
+    CallStats stats;
+
+    ASSERT_EQ(stats.percentile(50), 0U);
+
+    // 1..100: each percentile is bounded above by its bucket, within 25%
+    for (uint64_t v=1; v<=100; v++) {
+        stats.record(v);
+    }
+    for (uint32_t p=1; p<=100; p++) {
+        uint64_t v = stats.percentile(p);
+        ASSERT_GE(v, p) << "p=" << p;
+        ASSERT_LE(v, p + p/4 + 1) << "p=" << p;
+    }
+
+    // Never above the largest latency seen
+    ASSERT_EQ(stats.percentile(100), 100U);
+    ASSERT_EQ(stats.percentile(0), 1U);
+}
+
+TEST(CallStats, add) {
+    CallStats a, b;
+
+    a.record(5);
+    a.timeouts = 1;
+    b.record(1000);
+    b.record(7);
+    b.timeouts = 2;
+
+    a.add(b);
+    ASSERT_EQ(a.count, 3U);
+    ASSERT_EQ(a.timeouts, 3U);
+    ASSERT_EQ(a.total, 1012U);
+    ASSERT_EQ(a.max, 1000U);
+    ASSERT_EQ(a.buckets[CallStats::bucket(1000)], 1U);
+    ASSERT_EQ(a.percentile(100), 1000U);
+}
+
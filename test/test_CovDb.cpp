@@ -0,0 +1,226 @@
+/*
+ * test_CovDb.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include "gtest/gtest.h"
+#include "CovDb.h"
+
+using namespace zsp::sv;
+
+class CovDbTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_path = ::testing::TempDir() + "zsp_sv_covdb_"
+            + std::to_string(getpid()) + "_"
+            + ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    }
+
+    void TearDown() override {
+        unlink(m_path.c_str());
+    }
+
+    uint64_t fileSize() const {
+        struct stat st;
+        return (stat(m_path.c_str(), &st) == 0)?st.st_size:0;
+    }
+
+    void writeAt(uint64_t off, const void *data, size_t sz) {
+        int fd = ::open(m_path.c_str(), O_WRONLY);
+        ASSERT_NE(fd, -1);
+        ASSERT_EQ(pwrite(fd, data, sz, off), (ssize_t)sz);
+        ::close(fd);
+    }
+
+    void truncateTo(uint64_t size) {
+        ASSERT_EQ(truncate(m_path.c_str(), size), 0);
+    }
+
+    // Creates a database with items a[4] and b[2], and some hits
+    void mkDb() {
+        CovDbUP db(CovDb::create(m_path, 16, 1024, 1024));
+        ASSERT_TRUE(db);
+        ASSERT_EQ(db->addItem("a", 4), 0);
+        ASSERT_EQ(db->addItem("b", 2), 4);
+        db->hit(1);
+        db->add(4, 3);
+    }
+
+    CovDb *open(bool writable) {
+        std::string err;
+        CovDb *db = CovDb::open(m_path, writable, err);
+        EXPECT_TRUE(db) << err;
+        return db;
+    }
+
+    std::string openErr() {
+        std::string err;
+        CovDbUP db(CovDb::open(m_path, false, err));
+        EXPECT_FALSE(db);
+        return err;
+    }
+
+    std::string                 m_path;
+};
+
+TEST_F(CovDbTest, items) {
+    CovDbUP db(CovDb::create(m_path, 16, 1024, 1024));
+    ASSERT_TRUE(db);
+
+    ASSERT_EQ(db->addItem("a", 4), 0);
+    ASSERT_EQ(db->addItem("b", 2), 4);
+    ASSERT_EQ(db->header()->n_items, 2U);
+    ASSERT_EQ(db->header()->n_bins, 6U);
+    ASSERT_EQ(db->itemName(1), "b");
+
+    // Items are added once, and must keep their bin count
+    ASSERT_EQ(db->addItem("a", 4), 0);
+    ASSERT_EQ(db->addItem("a", 3), -1);
+    ASSERT_EQ(db->findItem("b", 2), 4);
+    ASSERT_EQ(db->findItem("b", 3), -1);
+    ASSERT_EQ(db->findItem("c", 2), -1);
+    ASSERT_EQ(db->header()->n_items, 2U);
+
+    db->hit(1);
+    db->hit(1);
+    db->add(3, 5);
+    ASSERT_EQ(db->count(1), 2U);
+    ASSERT_EQ(db->count(3), 5U);
+    ASSERT_EQ(db->numHit(0), 2U);
+    ASSERT_EQ(db->numHit(1), 0U);
+}
+
+TEST_F(CovDbTest, capacity) {
+    CovDbUP db(CovDb::create(m_path, 2, 8, 4));
+    ASSERT_TRUE(db);
+
+    ASSERT_EQ(db->addItem("ab", 6), 0);
+    // Out of bins, then names, then items
+    ASSERT_EQ(db->addItem("c", 3), -1);
+    ASSERT_EQ(db->addItem("cde", 2), -1);
+    ASSERT_EQ(db->addItem("c", 2), 6);
+    ASSERT_EQ(db->addItem("d", 0), -1);
+}
+
+TEST_F(CovDbTest, reopen) {
+    mkDb();
+
+    CovDbUP db(open(false));
+    ASSERT_TRUE(db);
+    ASSERT_EQ(db->header()->n_items, 2U);
+    ASSERT_EQ(db->findItem("a", 4), 0);
+    ASSERT_EQ(db->findItem("b", 2), 4);
+    ASSERT_EQ(db->count(1), 1U);
+    ASSERT_EQ(db->count(4), 3U);
+
+    // A read-only database can't add items
+    ASSERT_EQ(db->addItem("c", 1), -1);
+}
+
+TEST_F(CovDbTest, trimmed) {
+    mkDb();
+
+    // Closing trims the unused bin capacity, and the header with it
+    uint64_t size = fileSize();
+    {
+        CovDbUP db(open(false));
+        ASSERT_TRUE(db);
+        ASSERT_EQ(size, db->header()->bins_off + 6*sizeof(uint64_t));
+        ASSERT_EQ(db->header()->max_bins, 6U);
+    }
+
+    // Reopened for writing, existing items still count, but new bins
+    // would lie past the end of the file
+    {
+        CovDbUP db(open(true));
+        ASSERT_TRUE(db);
+        ASSERT_EQ(db->addItem("c", 1), -1);
+        ASSERT_EQ(db->addItem("a", 4), 0);
+        db->hit(5);
+    }
+    ASSERT_EQ(fileSize(), size);
+
+    CovDbUP db(open(false));
+    ASSERT_TRUE(db);
+    ASSERT_EQ(db->count(5), 1U);
+}
+
+TEST_F(CovDbTest, trimmedStaleHeader) {
+    mkDb();
+
+    // A file trimmed without updating its header has its capacity
+    // clamped to the file when reopened for writing
+    uint64_t max_bins = 1024;
+    writeAt(offsetof(CovDbHeader, max_bins), &max_bins, sizeof(max_bins));
+
+    CovDbUP db(open(true));
+    ASSERT_TRUE(db);
+    ASSERT_EQ(db->header()->max_bins, 6U);
+    ASSERT_EQ(db->addItem("c", 1), -1);
+}
+
+TEST_F(CovDbTest, invalid) {
+    ASSERT_NE(openErr().find("cannot open"), std::string::npos);
+
+    // Too short for a header
+    FILE *fp = fopen(m_path.c_str(), "wb");
+    ASSERT_TRUE(fp);
+    fputs("ZSPCOV", fp);
+    fclose(fp);
+    ASSERT_NE(openErr().find("is not a coverage database"), std::string::npos);
+
+    // Bad magic
+    mkDb();
+    writeAt(0, "XXXXXXXX", 8);
+    ASSERT_NE(openErr().find("is not a valid coverage database"), std::string::npos);
+
+    // Bad version
+    mkDb();
+    uint32_t version = CovDbHeader::VERSION + 1;
+    writeAt(offsetof(CovDbHeader, version), &version, sizeof(version));
+    ASSERT_NE(openErr().find("is not a valid coverage database"), std::string::npos);
+}
+
+TEST_F(CovDbTest, truncated) {
+    mkDb();
+
+    // Cut into the bins, then into the names
+    uint64_t bins_off, names_off;
+    {
+        CovDbUP db(open(false));
+        ASSERT_TRUE(db);
+        bins_off = db->header()->bins_off;
+        names_off = db->header()->names_off;
+    }
+
+    truncateTo(bins_off + 5*sizeof(uint64_t));
+    ASSERT_NE(openErr().find("is not a valid coverage database"), std::string::npos);
+
+    truncateTo(names_off + 1);
+    ASSERT_NE(openErr().find("is not a valid coverage database"), std::string::npos);
+
+    truncateTo(sizeof(CovDbHeader));
+    ASSERT_NE(openErr().find("is not a valid coverage database"), std::string::npos);
+}
+
@@ -0,0 +1,245 @@
+/*
+ * test_JournalFile.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "JournalFile.h"
+
+using namespace zsp::sv;
+
+static JournalEvent mkEvent(
+        uint8_t         kind,
+        int64_t         at_call,
+        uint64_t        call,
+        int64_t         value,
+        uint16_t        width=0,
+        uint8_t         is_signed=0) {
+    JournalEvent ev;
+    ev.kind = kind;
+    ev.is_signed = is_signed;
+    ev.width = width;
+    ev.at_call = at_call;
+    ev.call = call;
+    ev.value = value;
+    return ev;
+}
+
+static void expectEq(const JournalEvent &a, const JournalEvent &b) {
+    EXPECT_EQ(a.kind, b.kind);
+    EXPECT_EQ(a.is_signed, b.is_signed);
+    EXPECT_EQ(a.width, b.width);
+    EXPECT_EQ(a.at_call, b.at_call);
+    EXPECT_EQ(a.call, b.call);
+    EXPECT_EQ(a.value, b.value);
+}
+
+static std::vector<uint8_t> contents(FILE *fp) {
+    std::vector<uint8_t> ret;
+    uint8_t buf[4096];
+    size_t n;
+
+    fflush(fp);
+    rewind(fp);
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+        ret.insert(ret.end(), buf, buf+n);
+    }
+    return ret;
+}
+
+static FILE *mkFile(const std::vector<uint8_t> &data) {
+    FILE *fp = tmpfile();
+    fwrite(data.data(), 1, data.size(), fp);
+    rewind(fp);
+    return fp;
+}
+
+static JournalHeader mkHeader() {
+    JournalHeader hdr;
+    hdr.comp_t = "pss_top";
+    hdr.action_t = "pss_top::entry";
+    hdr.setup = "";
+    hdr.seed = "42";
+    hdr.reseeds = {"7", "8"};
+    hdr.n_calls = 1234;
+    return hdr;
+}
+
+TEST(JournalFile, eventLayout) {
+    JournalEvent ev = mkEvent(JournalEvent::IntResult, -1,
+        0x0102030405060708ULL, -2, 0x1234, 1);
+    uint8_t buf[JournalFile::EventSize];
+    const uint8_t exp[JournalFile::EventSize] = {
+        JournalEvent::IntResult, 1, 0x34, 0x12,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,
+        0xFE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+    // Fixed-width little-endian fields, independent of the host
+    JournalFile::pack(ev, buf);
+    ASSERT_EQ(memcmp(buf, exp, sizeof(exp)), 0);
+
+    JournalEvent ev_r;
+    JournalFile::unpack(buf, ev_r);
+    expectEq(ev_r, ev);
+}
+
+TEST(JournalFile, headerLayout) {
+    JournalHeader hdr;
+    hdr.comp_t = "C";
+    hdr.n_calls = 3;
+    FILE *fp = tmpfile();
+
+    ASSERT_TRUE(JournalFile::write(fp, hdr, 0, 0, {}));
+    std::vector<uint8_t> data = contents(fp);
+    fclose(fp);
+
+    const uint8_t exp[] = {
+        'Z', 'S', 'P', 'C', 'K', 'P', 'T', 0,
+        JournalFile::Version, 0, 0, 0,
+        1, 0, 0, 0, 'C',                // comp_t
+        0, 0, 0, 0,                     // action_t
+        0, 0, 0, 0,                     // setup
+        0, 0, 0, 0,                     // seed
+        0, 0, 0, 0,                     // reseeds
+        3, 0, 0, 0, 0, 0, 0, 0,         // n_calls
+        0, 0, 0, 0, 0, 0, 0, 0};        // events
+    ASSERT_EQ(data, std::vector<uint8_t>(exp, exp+sizeof(exp)));
+}
+
+TEST(JournalFile, roundTrip) {
+    JournalHeader hdr = mkHeader();
+    std::vector<JournalEvent> events = {
+        mkEvent(JournalEvent::Eval, -1, 0, 0),
+        mkEvent(JournalEvent::IntResult, -1, 0, -5, 8, 1),
+        mkEvent(JournalEvent::VoidResult, 0, 1, 0),
+        mkEvent(JournalEvent::Reseed, -1, 1, 0),
+        mkEvent(JournalEvent::Reseed, 2, 0, 0),
+        mkEvent(JournalEvent::Eval, -1, 0, 1000)};
+    FILE *fp = tmpfile();
+
+    ASSERT_TRUE(JournalFile::write(fp, hdr, 0, 0, events));
+    rewind(fp);
+
+    JournalHeader hdr_r;
+    std::vector<JournalEvent> events_r;
+    ASSERT_TRUE(JournalFile::read(fp, hdr_r, events_r));
+    fclose(fp);
+
+    ASSERT_EQ(hdr_r.comp_t, hdr.comp_t);
+    ASSERT_EQ(hdr_r.action_t, hdr.action_t);
+    ASSERT_EQ(hdr_r.setup, hdr.setup);
+    ASSERT_EQ(hdr_r.seed, hdr.seed);
+    ASSERT_EQ(hdr_r.reseeds, hdr.reseeds);
+    ASSERT_EQ(hdr_r.n_calls, hdr.n_calls);
+
+    ASSERT_EQ(events_r.size(), events.size());
+    for (uint32_t i=0; i<events.size(); i++) {
+        expectEq(events_r[i], events[i]);
+    }
+}
+
+TEST(JournalFile, packed) {
+    JournalHeader hdr = mkHeader();
+    std::vector<uint8_t> packed_d(2*JournalFile::EventSize);
+    std::vector<JournalEvent> events = {mkEvent(JournalEvent::Eval, -1, 0, 3)};
+
+    // Events already packed, as spilled by a compacted journal, come
+    // first. The spill file is left at its end, ready to append to
+    JournalFile::pack(mkEvent(JournalEvent::IntResult, -1, 0, 1, 32), &packed_d[0]);
+    JournalFile::pack(mkEvent(JournalEvent::IntResult, -1, 1, 2, 32),
+        &packed_d[JournalFile::EventSize]);
+    FILE *packed = mkFile(packed_d);
+    fseek(packed, 0, SEEK_END);
+
+    FILE *fp = tmpfile();
+    ASSERT_TRUE(JournalFile::write(fp, hdr, packed, 2, events));
+    ASSERT_EQ(ftell(packed), (long)packed_d.size());
+    fclose(packed);
+    rewind(fp);
+
+    JournalHeader hdr_r;
+    std::vector<JournalEvent> events_r;
+    ASSERT_TRUE(JournalFile::read(fp, hdr_r, events_r));
+    fclose(fp);
+
+    ASSERT_EQ(events_r.size(), 3U);
+    ASSERT_EQ(events_r[0].call, 0U);
+    ASSERT_EQ(events_r[0].value, 1);
+    ASSERT_EQ(events_r[1].call, 1U);
+    ASSERT_EQ(events_r[1].value, 2);
+    expectEq(events_r[2], events[0]);
+}
+
+TEST(JournalFile, packedShort) {
+    JournalHeader hdr = mkHeader();
+    std::vector<uint8_t> packed_d(JournalFile::EventSize);
+    FILE *packed = mkFile(packed_d);
+    FILE *fp = tmpfile();
+
+    // Fewer packed events than claimed is an error
+    ASSERT_FALSE(JournalFile::write(fp, hdr, packed, 2, {}));
+    fclose(packed);
+    fclose(fp);
+}
+
+TEST(JournalFile, invalid) {
+    JournalHeader hdr = mkHeader();
+    std::vector<JournalEvent> events = {
+        mkEvent(JournalEvent::Eval, -1, 0, 0),
+        mkEvent(JournalEvent::VoidResult, -1, 0, 0)};
+    FILE *fp = tmpfile();
+
+    ASSERT_TRUE(JournalFile::write(fp, hdr, 0, 0, events));
+    std::vector<uint8_t> data = contents(fp);
+    fclose(fp);
+
+    JournalHeader hdr_r;
+    std::vector<JournalEvent> events_r;
+
+    // Every truncation is detected
+    for (size_t len=0; len<data.size(); len++) {
+        FILE *t_fp = mkFile(std::vector<uint8_t>(data.begin(), data.begin()+len));
+        ASSERT_FALSE(JournalFile::read(t_fp, hdr_r, events_r)) << "len=" << len;
+        fclose(t_fp);
+    }
+
+    // Bad magic
+    std::vector<uint8_t> bad(data);
+    bad[0] = 'X';
+    fp = mkFile(bad);
+    ASSERT_FALSE(JournalFile::read(fp, hdr_r, events_r));
+    fclose(fp);
+
+    // Other versions
+    bad = data;
+    bad[8]++;
+    fp = mkFile(bad);
+    ASSERT_FALSE(JournalFile::read(fp, hdr_r, events_r));
+    fclose(fp);
+
+    fp = mkFile(data);
+    ASSERT_TRUE(JournalFile::read(fp, hdr_r, events_r));
+    ASSERT_EQ(events_r.size(), 2U);
+    fclose(fp);
+}
+
@@ -0,0 +1,215 @@
+/*
+ * test_SolutionTable.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+#include "dmgr/FactoryExt.h"
+#include "vsc/dm/FactoryExt.h"
+#include "vsc/solvers/FactoryExt.h"
+#include "SolutionTable.h"
+
+using namespace zsp::sv;
+
+static int prv_failures = 0;
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        fprintf(stdout, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        prv_failures++; \
+    } } while (0)
+
+/**
+ * Two random fields (a, b) and one non-random input (mode), standing in
+ * for the root fields of a solve. The test plays the part of the solver
+ */
+class Problem {
+public:
+    Problem(vsc::dm::IContext *ctxt) {
+        vsc::dm::IDataType *ui8 = ctxt->findDataTypeInt(false, 8);
+        m_a = vsc::dm::IModelFieldUP(ctxt->mkModelFieldRoot(ui8, "a"));
+        m_b = vsc::dm::IModelFieldUP(ctxt->mkModelFieldRoot(ui8, "b"));
+        m_mode = vsc::dm::IModelFieldUP(ctxt->mkModelFieldRoot(ui8, "mode"));
+        m_a->setFlag(vsc::dm::ModelFieldFlag::DeclRand);
+        m_b->setFlag(vsc::dm::ModelFieldFlag::DeclRand);
+        m_fields = {m_a.get(), m_b.get(), m_mode.get()};
+        setMode(0);
+    }
+
+    void setMode(uint64_t mode) {
+        m_mode->val()->set_val_u(mode, 8);
+    }
+
+    // Records (a, b) as the solver's result
+    void solve(SolutionTable &table, uint64_t a, uint64_t b, int32_t flags=0) {
+        m_a->val()->set_val_u(a, 8);
+        m_b->val()->set_val_u(b, 8);
+        table.record(m_fields, flags);
+    }
+
+    bool sample(
+        SolutionTable                   &table,
+        vsc::solvers::IRandState        *randstate,
+        int32_t                         flags=0) {
+        m_a->val()->set_val_u(0xFF, 8);
+        m_b->val()->set_val_u(0xFF, 8);
+        return table.sample(randstate, m_fields, flags);
+    }
+
+    std::pair<uint64_t,uint64_t> value() const {
+        return {m_a->val()->val_u(), m_b->val()->val_u()};
+    }
+
+private:
+    vsc::dm::IModelFieldUP                  m_a;
+    vsc::dm::IModelFieldUP                  m_b;
+    vsc::dm::IModelFieldUP                  m_mode;
+    std::vector<vsc::dm::IModelField *>     m_fields;
+};
+
+static const uint64_t prv_rows[][2] = {{1, 2}, {3, 4}, {5, 6}};
+
+// Records each of the three solutions, then 'repeats' already-seen ones
+static void learn(Problem &p, SolutionTable &table, uint32_t repeats, int32_t flags=0) {
+    for (uint32_t i=0; i<3+repeats; i++) {
+        p.solve(table, prv_rows[i%3][0], prv_rows[i%3][1], flags);
+    }
+}
+
+// Samples a complete table, retrying a sample that was left to the solver
+// for a recheck
+static bool sampled(
+        Problem                         &p,
+        SolutionTable                   &table,
+        vsc::solvers::IRandState        *randstate) {
+    for (uint32_t i=0; i<8; i++) {
+        if (p.sample(table, randstate)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_complete(vsc::solvers::IRandState *randstate) {
+    std::unique_ptr<vsc::dm::IContext> ctxt(vsc_dm_getFactory()->mkContext());
+    Problem p(ctxt.get());
+    SolutionTable table(16, 8);
+
+    CHECK(!p.sample(table, randstate));
+
+    // Complete once 'saturate' (8) solves, and at least twice the number
+    // of known solutions, have produced nothing new
+    learn(p, table, 7);
+    CHECK(!p.sample(table, randstate));
+    p.solve(table, 1, 2);
+    CHECK(sampled(p, table, randstate));
+
+    // Most samples are answered from the table, and a few are left to
+    // the solver to recheck it
+    std::set<std::pair<uint64_t,uint64_t>> seen;
+    uint32_t hits = 0;
+    for (uint32_t i=0; i<1024; i++) {
+        if (p.sample(table, randstate)) {
+            seen.insert(p.value());
+            hits++;
+        }
+    }
+    CHECK(hits < 1024 && hits > 1024 - 4*1024/SolutionTable::RecheckPeriod);
+    CHECK(seen.size() == 3);
+    CHECK(seen.count({1, 2}) && seen.count({3, 4}) && seen.count({5, 6}));
+
+    // A solution missed while learning is added by a recheck
+    p.solve(table, 7, 8);
+    seen.clear();
+    for (uint32_t i=0; i<1024; i++) {
+        if (p.sample(table, randstate)) {
+            seen.insert(p.value());
+        }
+    }
+    CHECK(seen.size() == 4 && seen.count({7, 8}));
+
+    table.clear();
+    CHECK(!p.sample(table, randstate));
+}
+
+static void test_inputs(vsc::solvers::IRandState *randstate) {
+    std::unique_ptr<vsc::dm::IContext> ctxt(vsc_dm_getFactory()->mkContext());
+    Problem p(ctxt.get());
+    SolutionTable table(16, 8);
+
+    p.setMode(1);
+    learn(p, table, 8);
+    CHECK(sampled(p, table, randstate));
+
+    // Different non-random inputs and flags have their own tables
+    p.setMode(2);
+    CHECK(!p.sample(table, randstate));
+    p.setMode(1);
+    CHECK(!p.sample(table, randstate, 1));
+    CHECK(sampled(p, table, randstate));
+}
+
+static void test_shared(vsc::solvers::IRandState *randstate) {
+    std::unique_ptr<vsc::dm::IContext> ctxt1(vsc_dm_getFactory()->mkContext());
+    std::unique_ptr<vsc::dm::IContext> ctxt2(vsc_dm_getFactory()->mkContext());
+    Problem p1(ctxt1.get()), p2(ctxt2.get());
+    SolutionTable table(16, 8);
+
+    // What one actor learns serves another with the same inputs
+    learn(p1, table, 4);
+    learn(p2, table, 4);
+    CHECK(sampled(p2, table, randstate));
+    CHECK(sampled(p1, table, randstate));
+
+    p2.setMode(1);
+    CHECK(!p2.sample(table, randstate));
+}
+
+static void test_overflow(vsc::solvers::IRandState *randstate) {
+    std::unique_ptr<vsc::dm::IContext> ctxt(vsc_dm_getFactory()->mkContext());
+    Problem p(ctxt.get());
+    SolutionTable table(2, 4);
+
+    learn(p, table, 64);
+    CHECK(!p.sample(table, randstate));
+}
+
+int main(int argc, char **argv) {
+    dmgr::IDebugMgr *dmgr = dmgr_getFactory()->getDebugMgr();
+    vsc_dm_getFactory()->init(dmgr);
+    vsc_solvers_getFactory()->init(dmgr);
+
+    vsc::solvers::IRandStateUP randstate(
+        vsc_solvers_getFactory()->mkRandState("0"));
+
+    test_complete(randstate.get());
+    test_inputs(randstate.get());
+    test_shared(randstate.get());
+    test_overflow(randstate.get());
+
+    if (prv_failures) {
+        fprintf(stdout, "%d checks failed\n", prv_failures);
+        return 1;
+    }
+    return 0;
+}
+
@@ -0,0 +1,200 @@
+/*
+ * test_SparseMem.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "SparseMem.h"
+
+using namespace zsp::sv;
+
+static const uint64_t PAGE = SparseMem::PAGE_SIZE;
+
+TEST(SparseMem, unwritten) {
+    SparseMem mem;
+    uint8_t data[16];
+    uint64_t val = 1;
+
+    memset(data, 0xFF, sizeof(data));
+    ASSERT_FALSE(mem.read(0x1000, data, sizeof(data)));
+    for (uint32_t i=0; i<sizeof(data); i++) {
+        ASSERT_EQ(data[i], 0);
+    }
+    ASSERT_FALSE(mem.readInt(0x2000, 8, val));
+    ASSERT_EQ(val, 0U);
+
+    // Reads don't allocate pages
+    ASSERT_EQ(mem.numPages(), 0U);
+}
+
+TEST(SparseMem, readWrite) {
+    SparseMem mem;
+    const uint8_t wdata[] = {1, 2, 3, 4, 5};
+    uint8_t rdata[5];
+
+    mem.write(0x100, wdata, sizeof(wdata));
+    ASSERT_TRUE(mem.read(0x100, rdata, sizeof(rdata)));
+    ASSERT_EQ(memcmp(rdata, wdata, sizeof(wdata)), 0);
+    ASSERT_EQ(mem.numPages(), 1U);
+
+    // Validity is tracked per byte
+    ASSERT_TRUE(mem.read(0x101, rdata, 3));
+    ASSERT_FALSE(mem.read(0xFF, rdata, 2));
+    ASSERT_EQ(rdata[0], 0);
+    ASSERT_EQ(rdata[1], 1);
+    ASSERT_FALSE(mem.read(0x104, rdata, 2));
+}
+
+TEST(SparseMem, ints) {
+    SparseMem mem;
+    uint64_t val;
+
+    for (uint32_t size=1; size<=8; size++) {
+        uint64_t addr = 0x1000*size + 3;
+        uint64_t mask = (size == 8)?~0ULL:((1ULL << (8*size)) - 1);
+        mem.writeInt(addr, size, 0x8877665544332211ULL);
+        ASSERT_TRUE(mem.readInt(addr, size, val));
+        ASSERT_EQ(val, 0x8877665544332211ULL & mask) << "size=" << size;
+    }
+
+    // Little-endian
+    uint8_t b;
+    mem.writeInt(0x10, 4, 0xAABBCCDD);
+    ASSERT_TRUE(mem.read(0x10, &b, 1));
+    ASSERT_EQ(b, 0xDD);
+    ASSERT_TRUE(mem.read(0x13, &b, 1));
+    ASSERT_EQ(b, 0xAA);
+}
+
+TEST(SparseMem, crossPage) {
+    SparseMem mem;
+    std::vector<uint8_t> wdata(PAGE+16), rdata(PAGE+16);
+    uint64_t val;
+
+    for (uint32_t i=0; i<wdata.size(); i++) {
+        wdata[i] = i*7;
+    }
+
+    // Spans three pages
+    mem.write(3*PAGE - 8, wdata.data(), wdata.size());
+    ASSERT_EQ(mem.numPages(), 3U);
+    ASSERT_TRUE(mem.read(3*PAGE - 8, rdata.data(), rdata.size()));
+    ASSERT_EQ(rdata, wdata);
+
+    mem.writeInt(8*PAGE - 3, 8, 0x0102030405060708ULL);
+    ASSERT_TRUE(mem.readInt(8*PAGE - 3, 8, val));
+    ASSERT_EQ(val, 0x0102030405060708ULL);
+
+    // Partly unwritten
+    ASSERT_FALSE(mem.readInt(3*PAGE - 12, 8, val));
+    ASSERT_EQ(val, uint64_t(wdata[0]) << 32 | uint64_t(wdata[1]) << 40
+        | uint64_t(wdata[2]) << 48 | uint64_t(wdata[3]) << 56);
+}
+
+TEST(SparseMem, pages) {
+    SparseMem mem;
+    uint64_t top = ~0ULL - 7;
+
+    mem.writeInt(top, 8, 1);
+    mem.writeInt(5*PAGE + 1, 1, 1);
+    mem.writeInt(0, 1, 1);
+    mem.writeInt(5*PAGE + 2, 1, 1);
+
+    std::vector<uint64_t> pages = mem.pages();
+    ASSERT_EQ(pages, (std::vector<uint64_t>{0, 5*PAGE, top & ~(PAGE-1)}));
+
+    // The list is a snapshot
+    mem.writeInt(2*PAGE, 1, 1);
+    ASSERT_EQ(pages.size(), 3U);
+    ASSERT_EQ(mem.numPages(), 4U);
+}
+
+TEST(SparseMem, pagesFrom) {
+    SparseMem mem;
+    uint64_t top = ~0ULL - 7;
+    uint64_t addrs[2];
+
+    mem.writeInt(top, 8, 1);
+    mem.writeInt(7*PAGE, 1, 1);
+    mem.writeInt(0, 1, 1);
+    mem.writeInt(5*PAGE, 1, 1);
+
+    // Walked in chunks, continuing after the last page returned
+    ASSERT_EQ(mem.pages(0, addrs, 2), 2U);
+    ASSERT_EQ(addrs[0], 0U);
+    ASSERT_EQ(addrs[1], 5*PAGE);
+    ASSERT_EQ(mem.pages(5*PAGE + PAGE, addrs, 2), 2U);
+    ASSERT_EQ(addrs[0], 7*PAGE);
+    ASSERT_EQ(addrs[1], top & ~(PAGE-1));
+
+    // An unaligned start skips the page that holds it
+    ASSERT_EQ(mem.pages(5*PAGE + 1, addrs, 2), 2U);
+    ASSERT_EQ(addrs[0], 7*PAGE);
+    ASSERT_EQ(mem.pages(top, addrs, 2), 0U);
+}
+
+TEST(SparseMem, clear) {
+    SparseMem mem;
+    uint64_t val;
+
+    mem.writeInt(0x40, 4, 0x12345678);
+    ASSERT_TRUE(mem.readInt(0x40, 4, val));
+
+    // Clearing also drops the most-recently used page
+    mem.clear();
+    ASSERT_EQ(mem.numPages(), 0U);
+    ASSERT_FALSE(mem.readInt(0x40, 4, val));
+    ASSERT_EQ(val, 0U);
+
+    mem.writeInt(0x44, 4, 0x12345678);
+    ASSERT_FALSE(mem.readInt(0x40, 4, val));
+    ASSERT_TRUE(mem.readInt(0x44, 4, val));
+}
+
+TEST(SparseMem, threads) {
+    SparseMem mem;
+    std::vector<std::thread> threads;
+    const uint32_t N_THREADS = 4, N_WORDS = 4096;
+
+    // Interleaved accesses from several actors' threads
+    for (uint32_t t=0; t<N_THREADS; t++) {
+        threads.push_back(std::thread([&mem, t]() {
+            for (uint32_t i=0; i<N_WORDS; i++) {
+                uint64_t addr = 8*(uint64_t(i)*N_THREADS + t);
+                mem.writeInt(addr, 8, addr);
+            }
+        }));
+    }
+    for (std::vector<std::thread>::iterator
+        it=threads.begin();
+        it!=threads.end(); it++) {
+        it->join();
+    }
+
+    for (uint64_t addr=0; addr<8*N_THREADS*N_WORDS; addr+=8) {
+        uint64_t val;
+        ASSERT_TRUE(mem.readInt(addr, 8, val));
+        ASSERT_EQ(val, addr);
+    }
+    ASSERT_EQ(mem.numPages(), 8*N_THREADS*N_WORDS/PAGE);
+}
+
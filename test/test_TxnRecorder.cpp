@@ -0,0 +1,214 @@
+/*
+ * test_TxnRecorder.cpp
+ *
+ * Copyright 2023 Matthew Ballance and Contributors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may
+ * not use this file except in compliance with the License.
+ * You may obtain a copy of the License at:
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Created on:
+ *     Author:
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "dmgr/FactoryExt.h"
+#include "vsc/dm/FactoryExt.h"
+#include "zsp/arl/dm/FactoryExt.h"
+#include "SimTime.h"
+#include "TxnRecorder.h"
+
+using namespace zsp::sv;
+
+/**
+ * Reads back a transaction file, in the layout documented by TxnRecord
+ */
+class TxnReader {
+public:
+    TxnReader(const std::string &path) : m_off(0) {
+        FILE *fp = fopen(path.c_str(), "rb");
+        if (fp) {
+            uint8_t buf[4096];
+            size_t n;
+            while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+                m_data.insert(m_data.end(), buf, buf+n);
+            }
+            fclose(fp);
+        }
+    }
+
+    template <class T> T get() {
+        T v = 0;
+        for (uint32_t i=0; i<sizeof(T) && m_off < m_data.size(); i++) {
+            v |= static_cast<T>(static_cast<uint64_t>(m_data[m_off++]) << (8*i));
+        }
+        return v;
+    }
+
+    std::string getStr() {
+        uint16_t len = get<uint16_t>();
+        std::string ret(reinterpret_cast<const char *>(&m_data[m_off]), len);
+        m_off += len;
+        return ret;
+    }
+
+    bool done() const {
+        return m_off >= m_data.size();
+    }
+
+    size_t size() const {
+        return m_data.size();
+    }
+
+private:
+    std::vector<uint8_t>        m_data;
+    size_t                      m_off;
+};
+
+class TxnRecorderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        dmgr::IDebugMgr *dmgr = dmgr_getFactory()->getDebugMgr();
+        vsc_dm_getFactory()->init(dmgr);
+        zsp_arl_dm_getFactory()->init(dmgr);
+        m_ctxt = std::unique_ptr<zsp::arl::dm::IContext>(
+            zsp_arl_dm_getFactory()->mkContext(vsc_dm_getFactory()->mkContext()));
+        m_path = ::testing::TempDir() + "zsp_sv_txn_"
+            + std::to_string(getpid()) + "_"
+            + ::testing::UnitTest::GetInstance()->current_test_info()->name();
+        SimTime::set(0);
+    }
+
+    void TearDown() override {
+        unlink(m_path.c_str());
+    }
+
+    zsp::arl::dm::IDataTypeAction *mkAction(const std::string &name) {
+        zsp::arl::dm::IDataTypeAction *ret = m_ctxt->mkDataTypeAction(name);
+        m_actions.push_back(std::unique_ptr<zsp::arl::dm::IDataTypeAction>(ret));
+        return ret;
+    }
+
+    void checkHeader(TxnReader &rd) {
+        char magic[8];
+        for (uint32_t i=0; i<8; i++) {
+            magic[i] = rd.get<uint8_t>();
+        }
+        uint32_t version = TxnRecord::VERSION;
+        ASSERT_EQ(memcmp(magic, "ZSPTXN\0\0", 8), 0);
+        ASSERT_EQ(rd.get<uint32_t>(), version);
+    }
+
+    void checkType(TxnReader &rd, uint32_t id, const std::string &name) {
+        ASSERT_EQ(rd.get<uint8_t>(), TxnRecord::Type);
+        ASSERT_EQ(rd.get<uint32_t>(), id);
+        ASSERT_EQ(rd.getStr(), name);
+        ASSERT_EQ(rd.get<uint16_t>(), 0);
+    }
+
+    void checkBegin(
+            TxnReader       &rd,
+            uint64_t        txn,
+            uint32_t        actor,
+            uint32_t        type,
+            uint64_t        parent,
+            uint64_t        time) {
+        ASSERT_EQ(rd.get<uint8_t>(), TxnRecord::Begin);
+        ASSERT_EQ(rd.get<uint64_t>(), txn);
+        ASSERT_EQ(rd.get<uint32_t>(), actor);
+        ASSERT_EQ(rd.get<uint32_t>(), type);
+        ASSERT_EQ(rd.get<uint64_t>(), parent);
+        ASSERT_EQ(rd.get<uint64_t>(), time);
+    }
+
+    void checkEnd(TxnReader &rd, uint64_t txn, uint64_t time) {
+        ASSERT_EQ(rd.get<uint8_t>(), TxnRecord::End);
+        ASSERT_EQ(rd.get<uint64_t>(), txn);
+        ASSERT_EQ(rd.get<uint64_t>(), time);
+    }
+
+    std::unique_ptr<zsp::arl::dm::IContext>                         m_ctxt;
+    std::vector<std::unique_ptr<zsp::arl::dm::IDataTypeAction>>     m_actions;
+    std::string                                                     m_path;
+};
+
+TEST_F(TxnRecorderTest, records) {
+    zsp::arl::dm::IDataTypeAction *a_t = mkAction("A");
+    zsp::arl::dm::IDataTypeAction *b_t = mkAction("B");
+    TxnRecorderUP rec(TxnRecorder::create(m_path));
+    ASSERT_TRUE(rec);
+
+    SimTime::set(100);
+    uint64_t a = rec->begin(3, a_t, vsc::dm::ValRef(), 0);
+    SimTime::set(150);
+    uint64_t b = rec->begin(3, b_t, vsc::dm::ValRef(), a+1);
+    SimTime::set(200);
+    rec->end(b);
+    uint64_t a2 = rec->begin(4, a_t, vsc::dm::ValRef(), 0);
+    SimTime::set(300);
+    rec->end(a);
+    rec->end(a2);
+    rec->flush();
+
+    ASSERT_EQ(a, 0U);
+    ASSERT_EQ(b, 1U);
+    ASSERT_EQ(a2, 2U);
+    ASSERT_EQ(rec->numTxns(), 3U);
+
+    // Each type is described once, before its first use
+    TxnReader rd(m_path);
+    ASSERT_EQ(rd.size(), rec->bytes());
+    checkHeader(rd);
+    checkType(rd, 0, "A");
+    checkBegin(rd, 0, 3, 0, 0, 100);
+    checkType(rd, 1, "B");
+    checkBegin(rd, 1, 3, 1, 1, 150);
+    checkEnd(rd, 1, 200);
+    checkBegin(rd, 2, 4, 0, 0, 200);
+    checkEnd(rd, 0, 300);
+    checkEnd(rd, 2, 300);
+    ASSERT_TRUE(rd.done());
+}
+
+TEST_F(TxnRecorderTest, close) {
+    zsp::arl::dm::IDataTypeAction *a_t = mkAction("A");
+    TxnRecorderUP rec(TxnRecorder::create(m_path));
+    ASSERT_TRUE(rec);
+
+    // Records made after the last flush are written when the recorder
+    // is destroyed
+    const uint32_t N_TXNS = 10000;
+    for (uint32_t i=0; i<N_TXNS; i++) {
+        SimTime::set(i);
+        rec->end(rec->begin(0, a_t, vsc::dm::ValRef(), 0));
+    }
+    rec.reset();
+
+    TxnReader rd(m_path);
+    checkHeader(rd);
+    checkType(rd, 0, "A");
+    for (uint32_t i=0; i<N_TXNS; i++) {
+        ASSERT_NO_FATAL_FAILURE(checkBegin(rd, i, 0, 0, 0, i));
+        ASSERT_NO_FATAL_FAILURE(checkEnd(rd, i, i));
+    }
+    ASSERT_TRUE(rd.done());
+}
+
+TEST_F(TxnRecorderTest, createFails) {
+    TxnRecorderUP rec(TxnRecorder::create(m_path + "/no/such/dir"));
+    ASSERT_FALSE(rec);
+}
+